@@ -0,0 +1,65 @@
+#include "Arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace PyInterpreter;
+
+void* Arena::allocate(size_t size, size_t align) {
+  uintptr_t next = reinterpret_cast<uintptr_t>(m_next);
+  uintptr_t aligned = (next + align - 1) & ~(uintptr_t)(align - 1);
+  if (m_next == nullptr || aligned + size > reinterpret_cast<uintptr_t>(m_end)) {
+    // Oversized requests get a dedicated block so the current one keeps
+    // serving small nodes.
+    size_t blockSize = size + align > kBlockSize ? size + align : kBlockSize;
+    char* block = static_cast<char*>(::operator new(blockSize));
+    m_blocks.push_back(block);
+    m_bytesAllocated += blockSize;
+    if (blockSize != kBlockSize) {
+      uintptr_t start = reinterpret_cast<uintptr_t>(block);
+      return reinterpret_cast<void*>((start + align - 1) &
+                                     ~(uintptr_t)(align - 1));
+    }
+    m_next = block;
+    m_end = block + blockSize;
+    next = reinterpret_cast<uintptr_t>(m_next);
+    aligned = (next + align - 1) & ~(uintptr_t)(align - 1);
+  }
+  m_next = reinterpret_cast<char*>(aligned + size);
+  return reinterpret_cast<void*>(aligned);
+}
+
+void Arena::reset() {
+  if (m_next == nullptr) return release();
+  char* current = m_end - kBlockSize;
+  m_blocks.erase(std::find(m_blocks.begin(), m_blocks.end(), current));
+  release();
+  m_blocks.push_back(current);
+  m_bytesAllocated = kBlockSize;
+  m_next = current;
+  m_end = current + kBlockSize;
+}
+
+void Arena::adopt(Arena& other) {
+  m_destructors.insert(m_destructors.end(), other.m_destructors.begin(),
+                       other.m_destructors.end());
+  m_blocks.insert(m_blocks.end(), other.m_blocks.begin(), other.m_blocks.end());
+  m_bytesAllocated += other.m_bytesAllocated;
+  other.m_destructors.clear();
+  other.m_blocks.clear();
+  other.m_next = nullptr;
+  other.m_end = nullptr;
+  other.m_bytesAllocated = 0;
+}
+
+void Arena::release() {
+  for (auto it = m_destructors.rbegin(); it != m_destructors.rend(); ++it) {
+    it->destroy(it->object);
+  }
+  m_destructors.clear();
+  for (char* block : m_blocks) ::operator delete(block);
+  m_blocks.clear();
+  m_next = nullptr;
+  m_end = nullptr;
+  m_bytesAllocated = 0;
+}
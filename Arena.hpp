@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace PyInterpreter {
+// Bump allocator for objects that share one lifetime, such as the nodes of a
+// parsed program. Objects are carved out of large blocks; release() runs the
+// pending destructors in reverse order and frees every block at once.
+class Arena {
+ public:
+  Arena() {}
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+  ~Arena() { release(); }
+
+  template <typename T, typename... Args>
+  T* make(Args&&... args) {
+    void* memory = allocate(sizeof(T), alignof(T));
+    T* object = new (memory) T(std::forward<Args>(args)...);
+    if (!std::is_trivially_destructible<T>::value) {
+      m_destructors.push_back({object, &destroy<T>});
+    }
+    return object;
+  }
+
+  void* allocate(size_t size, size_t align);
+  void release();
+  // Like release(), but keeps the current block to serve the next objects.
+  void reset();
+  // Takes over every object and block of other, which is left empty.
+  void adopt(Arena& other);
+
+  size_t bytesAllocated() const { return m_bytesAllocated; }
+
+ private:
+  struct Destructor {
+    void* object;
+    void (*destroy)(void*);
+  };
+
+  template <typename T>
+  static void destroy(void* object) {
+    static_cast<T*>(object)->~T();
+  }
+
+  static const size_t kBlockSize = 64 * 1024;
+
+  std::vector<char*> m_blocks;
+  std::vector<Destructor> m_destructors;
+  char* m_next = nullptr;
+  char* m_end = nullptr;
+  size_t m_bytesAllocated = 0;
+};
+}  // namespace PyInterpreter
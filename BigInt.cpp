@@ -0,0 +1,306 @@
+#include "BigInt.hpp"
+
+#include <algorithm>
+
+using namespace PyInterpreter;
+
+namespace {
+// Magnitude of INT64_MIN, the largest int64_t magnitude.
+const uint64_t kInt64MinMagnitude = uint64_t(1) << 63;
+}  // namespace
+
+BigInt::BigInt(int64_t value) {
+  m_negative = value < 0;
+  uint64_t magnitude = m_negative ? 0 - static_cast<uint64_t>(value)
+                                  : static_cast<uint64_t>(value);
+  while (magnitude != 0) {
+    m_limbs.push_back(magnitude % kBase);
+    magnitude /= kBase;
+  }
+}
+
+BigInt BigInt::parse(std::string_view digits) {
+  Limbs limbs;
+  limbs.reserve(digits.size() / kBaseDigits + 1);
+  for (size_t end = digits.size(); end > 0;) {
+    size_t begin = end > kBaseDigits ? end - kBaseDigits : 0;
+    uint32_t limb = 0;
+    for (size_t i = begin; i < end; i++) limb = limb * 10 + (digits[i] - '0');
+    limbs.push_back(limb);
+    end = begin;
+  }
+  return fromMagnitude(std::move(limbs), false);
+}
+
+bool BigInt::fitsInt64() const {
+  if (m_limbs.size() < 3) return true;
+  if (m_limbs.size() > 3 || m_limbs[2] > 9) return false;
+  uint64_t magnitude = m_limbs[2] * uint64_t(kBase) * kBase +
+                       m_limbs[1] * uint64_t(kBase) + m_limbs[0];
+  return magnitude < kInt64MinMagnitude ||
+         (m_negative && magnitude == kInt64MinMagnitude);
+}
+
+int64_t BigInt::toInt64() const {
+  uint64_t magnitude = 0;
+  for (size_t i = m_limbs.size(); i-- > 0;) {
+    magnitude = magnitude * kBase + m_limbs[i];
+  }
+  return m_negative ? static_cast<int64_t>(0 - magnitude)
+                    : static_cast<int64_t>(magnitude);
+}
+
+std::string BigInt::toString() const {
+  if (isZero()) return "0";
+  std::string out;
+  out.reserve(m_limbs.size() * kBaseDigits + 1);
+  if (m_negative) out += '-';
+  out += std::to_string(m_limbs.back());
+  char digits[kBaseDigits];
+  for (size_t i = m_limbs.size() - 1; i-- > 0;) {
+    uint32_t limb = m_limbs[i];
+    for (int d = kBaseDigits - 1; d >= 0; d--) {
+      digits[d] = '0' + limb % 10;
+      limb /= 10;
+    }
+    out.append(digits, kBaseDigits);
+  }
+  return out;
+}
+
+int BigInt::compare(const BigInt& other) const {
+  if (m_negative != other.m_negative) return m_negative ? -1 : 1;
+  int order = compareMagnitude(m_limbs, other.m_limbs);
+  return m_negative ? -order : order;
+}
+
+BigInt BigInt::operator-() const {
+  BigInt result = *this;
+  if (!result.isZero()) result.m_negative = !m_negative;
+  return result;
+}
+
+BigInt BigInt::operator+(const BigInt& other) const {
+  if (m_negative == other.m_negative) {
+    return fromMagnitude(addMagnitude(m_limbs, other.m_limbs), m_negative);
+  }
+  if (compareMagnitude(m_limbs, other.m_limbs) >= 0) {
+    return fromMagnitude(subtractMagnitude(m_limbs, other.m_limbs),
+                         m_negative);
+  }
+  return fromMagnitude(subtractMagnitude(other.m_limbs, m_limbs),
+                       other.m_negative);
+}
+
+BigInt BigInt::operator-(const BigInt& other) const { return *this + -other; }
+
+BigInt BigInt::operator*(const BigInt& other) const {
+  return fromMagnitude(multiplyMagnitude(m_limbs, other.m_limbs),
+                       m_negative != other.m_negative);
+}
+
+BigInt BigInt::operator/(const BigInt& other) const {
+  return fromMagnitude(divideMagnitude(m_limbs, other.m_limbs),
+                       m_negative != other.m_negative);
+}
+
+BigInt BigInt::fromMagnitude(Limbs limbs, bool negative) {
+  trim(limbs);
+  BigInt result;
+  result.m_limbs = std::move(limbs);
+  result.m_negative = negative && !result.m_limbs.empty();
+  return result;
+}
+
+void BigInt::trim(Limbs& limbs) {
+  while (!limbs.empty() && limbs.back() == 0) limbs.pop_back();
+}
+
+int BigInt::compareMagnitude(const Limbs& a, const Limbs& b) {
+  if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+  for (size_t i = a.size(); i-- > 0;) {
+    if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+  }
+  return 0;
+}
+
+BigInt::Limbs BigInt::addMagnitude(const Limbs& a, const Limbs& b) {
+  const Limbs& longer = a.size() >= b.size() ? a : b;
+  const Limbs& shorter = a.size() >= b.size() ? b : a;
+  Limbs sum(longer.size() + 1);
+  uint32_t carry = 0;
+  for (size_t i = 0; i < longer.size(); i++) {
+    uint32_t limb = longer[i] + carry + (i < shorter.size() ? shorter[i] : 0);
+    carry = limb >= kBase;
+    sum[i] = carry ? limb - kBase : limb;
+  }
+  sum[longer.size()] = carry;
+  trim(sum);
+  return sum;
+}
+
+BigInt::Limbs BigInt::subtractMagnitude(const Limbs& a, const Limbs& b) {
+  Limbs difference(a.size());
+  int64_t borrow = 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    int64_t limb = int64_t(a[i]) - borrow - (i < b.size() ? b[i] : 0);
+    borrow = limb < 0;
+    difference[i] = borrow ? limb + kBase : limb;
+  }
+  trim(difference);
+  return difference;
+}
+
+BigInt::Limbs BigInt::multiplyMagnitude(const Limbs& a, const Limbs& b) {
+  if (a.empty() || b.empty()) return Limbs();
+  if (std::min(a.size(), b.size()) < kKaratsubaThreshold) {
+    return schoolbook(a, b);
+  }
+  return karatsuba(a, b);
+}
+
+BigInt::Limbs BigInt::schoolbook(const Limbs& a, const Limbs& b) {
+  Limbs product(a.size() + b.size());
+  for (size_t i = 0; i < a.size(); i++) {
+    const uint64_t limb = a[i];
+    if (limb == 0) continue;
+    uint64_t carry = 0;
+    for (size_t j = 0; j < b.size(); j++) {
+      uint64_t current = product[i + j] + limb * b[j] + carry;
+      product[i + j] = current % kBase;
+      carry = current / kBase;
+    }
+    for (size_t k = i + b.size(); carry != 0; k++) {
+      uint64_t current = product[k] + carry;
+      product[k] = current % kBase;
+      carry = current / kBase;
+    }
+  }
+  trim(product);
+  return product;
+}
+
+BigInt::Limbs BigInt::karatsuba(const Limbs& a, const Limbs& b) {
+  const Limbs& longer = a.size() >= b.size() ? a : b;
+  const Limbs& shorter = a.size() >= b.size() ? b : a;
+  const size_t half = (longer.size() + 1) / 2;
+  Limbs longLow(longer.begin(), longer.begin() + half);
+  Limbs longHigh(longer.begin() + half, longer.end());
+  trim(longLow);
+
+  Limbs product(a.size() + b.size() + 1);
+  if (shorter.size() <= half) {
+    // Too lopsided to split both operands; split the longer one only.
+    addShifted(product, multiplyMagnitude(longLow, shorter), 0);
+    addShifted(product, multiplyMagnitude(longHigh, shorter), half);
+    trim(product);
+    return product;
+  }
+
+  Limbs shortLow(shorter.begin(), shorter.begin() + half);
+  Limbs shortHigh(shorter.begin() + half, shorter.end());
+  trim(shortLow);
+
+  // (x1*B + x0)(y1*B + y0) = z2*B^2 + ((x0 + x1)(y0 + y1) - z2 - z0)*B + z0
+  Limbs z0 = multiplyMagnitude(longLow, shortLow);
+  Limbs z2 = multiplyMagnitude(longHigh, shortHigh);
+  Limbs z1 = multiplyMagnitude(addMagnitude(longLow, longHigh),
+                               addMagnitude(shortLow, shortHigh));
+  z1 = subtractMagnitude(subtractMagnitude(z1, z0), z2);
+
+  addShifted(product, z0, 0);
+  addShifted(product, z1, half);
+  addShifted(product, z2, 2 * half);
+  trim(product);
+  return product;
+}
+
+void BigInt::addShifted(Limbs& target, const Limbs& value, size_t shift) {
+  uint32_t carry = 0;
+  size_t i = 0;
+  for (; i < value.size(); i++) {
+    uint32_t limb = target[shift + i] + value[i] + carry;
+    carry = limb >= kBase;
+    target[shift + i] = carry ? limb - kBase : limb;
+  }
+  for (size_t k = shift + i; carry != 0; k++) {
+    uint32_t limb = target[k] + carry;
+    carry = limb >= kBase;
+    target[k] = carry ? limb - kBase : limb;
+  }
+}
+
+BigInt::Limbs BigInt::divideMagnitude(const Limbs& a, const Limbs& b) {
+  if (compareMagnitude(a, b) < 0) return Limbs();
+
+  Limbs quotient(a.size() - b.size() + 1);
+  if (b.size() == 1) {
+    uint64_t remainder = 0;
+    for (size_t i = a.size(); i-- > 0;) {
+      uint64_t current = remainder * kBase + a[i];
+      quotient[i] = current / b[0];
+      remainder = current % b[0];
+    }
+    trim(quotient);
+    return quotient;
+  }
+
+  // Knuth's algorithm D: scale both operands so the divisor's top limb is
+  // at least kBase / 2, which keeps each quotient estimate within two of
+  // the true limb.
+  const uint64_t scale = kBase / (uint64_t(b.back()) + 1);
+  auto scaled = [scale](const Limbs& limbs) {
+    Limbs result(limbs.size() + 1);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < limbs.size(); i++) {
+      uint64_t current = limbs[i] * scale + carry;
+      result[i] = current % kBase;
+      carry = current / kBase;
+    }
+    result[limbs.size()] = carry;
+    return result;
+  };
+  Limbs u = scaled(a);
+  Limbs v = scaled(b);
+  trim(v);
+
+  const size_t n = v.size();
+  for (size_t j = a.size() - n + 1; j-- > 0;) {
+    uint64_t numerator = u[j + n] * uint64_t(kBase) + u[j + n - 1];
+    uint64_t estimate = numerator / v[n - 1];
+    uint64_t remainder = numerator % v[n - 1];
+    while (estimate >= kBase ||
+           estimate * v[n - 2] > remainder * kBase + u[j + n - 2]) {
+      estimate--;
+      remainder += v[n - 1];
+      if (remainder >= kBase) break;
+    }
+
+    // u[j .. j + n] -= estimate * v
+    uint64_t carry = 0;
+    int64_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+      uint64_t product = estimate * v[i] + carry;
+      carry = product / kBase;
+      int64_t limb = int64_t(u[i + j]) - int64_t(product % kBase) - borrow;
+      borrow = limb < 0;
+      u[i + j] = borrow ? limb + kBase : limb;
+    }
+    int64_t top = int64_t(u[j + n]) - int64_t(carry) - borrow;
+    if (top < 0) {
+      // The estimate was one too large; add the divisor back.
+      estimate--;
+      uint32_t addCarry = 0;
+      for (size_t i = 0; i < n; i++) {
+        uint32_t limb = u[i + j] + v[i] + addCarry;
+        addCarry = limb >= kBase;
+        u[i + j] = addCarry ? limb - kBase : limb;
+      }
+      top += addCarry;
+    }
+    u[j + n] = top;
+    quotient[j] = estimate;
+  }
+  trim(quotient);
+  return quotient;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PyInterpreter {
+// Arbitrary-precision signed integer: a sign and a little-endian magnitude
+// in base 10^9, so decimal conversion needs no long division. Values only
+// reach this type once they no longer fit in an int64_t; Value keeps small
+// integers inline.
+class BigInt {
+ public:
+  BigInt() {}
+  explicit BigInt(int64_t value);
+
+  // Parses a run of decimal digits, as produced by the Scanner.
+  static BigInt parse(std::string_view digits);
+
+  bool isZero() const { return m_limbs.empty(); }
+  bool isNegative() const { return m_negative; }
+  bool fitsInt64() const;
+  // Only meaningful when fitsInt64().
+  int64_t toInt64() const;
+  std::string toString() const;
+
+  // Negative, zero or positive as *this is less than, equal to or greater
+  // than other.
+  int compare(const BigInt& other) const;
+
+  BigInt operator-() const;
+  BigInt operator+(const BigInt& other) const;
+  BigInt operator-(const BigInt& other) const;
+  BigInt operator*(const BigInt& other) const;
+  // Quotient truncated toward zero, matching int64_t division. other must
+  // not be zero.
+  BigInt operator/(const BigInt& other) const;
+
+ private:
+  typedef std::vector<uint32_t> Limbs;
+
+  static const uint32_t kBase = 1000000000;
+  static const int kBaseDigits = 9;
+  // Below this many limbs schoolbook multiplication beats Karatsuba.
+  static const size_t kKaratsubaThreshold = 48;
+
+  static BigInt fromMagnitude(Limbs limbs, bool negative);
+  static void trim(Limbs& limbs);
+  static int compareMagnitude(const Limbs& a, const Limbs& b);
+  static Limbs addMagnitude(const Limbs& a, const Limbs& b);
+  // Requires a >= b.
+  static Limbs subtractMagnitude(const Limbs& a, const Limbs& b);
+  static Limbs multiplyMagnitude(const Limbs& a, const Limbs& b);
+  static Limbs schoolbook(const Limbs& a, const Limbs& b);
+  static Limbs karatsuba(const Limbs& a, const Limbs& b);
+  static Limbs divideMagnitude(const Limbs& a, const Limbs& b);
+  static void addShifted(Limbs& target, const Limbs& value, size_t shift);
+
+  bool m_negative = false;
+  // No high zero limbs; empty for zero.
+  Limbs m_limbs;
+};
+}  // namespace PyInterpreter
@@ -0,0 +1,174 @@
+#include "Builtins.hpp"
+
+#include <utility>
+
+#include "Kernels.hpp"
+#include "Operators.hpp"
+
+using namespace PyInterpreter;
+
+namespace {
+const char* const kLenOperand = "len() needs a list or a string.";
+const char* const kListOperand = "Argument must be a list!";
+const char* const kNumberElements = "sum() needs a list of numbers.";
+const char* const kEmptyList = "Argument must not be an empty list!";
+const char* const kListOperands = "At least one argument must be a list!";
+const char* const kLengthMismatch = "Lists must have the same length!";
+
+bool len(const Value* args, Value& result, const char*& error) {
+  if (args[0].isList()) {
+    result = Value::integer(args[0].asList()->size());
+  } else if (args[0].isString()) {
+    result = Value::integer(args[0].asString().size());
+  } else {
+    error = kLenOperand;
+    return false;
+  }
+  return true;
+}
+
+bool sum(const Value* args, Value& result, const char*& error) {
+  if (!args[0].isList()) {
+    error = kListOperand;
+    return false;
+  }
+  const ListObj& list = *args[0].asList();
+  if (list.unboxed()) {
+    int64_t total;
+    if (Kernels::sum(list.ints().data(), list.size(), total)) {
+      result = Value::integer(total);
+    } else {
+      BigInt big(0);
+      for (int64_t value : list.ints()) big = big + BigInt(value);
+      result = Value::bigint(std::move(big));
+    }
+    return true;
+  }
+  Value total = Value::integer(0);
+  for (const Value& value : list.values()) {
+    if (!value.isNumber()) {
+      error = kNumberElements;
+      return false;
+    }
+    Value next;
+    if (!Operators::binary(Token::TokenType::PLUS, total, value, next,
+                           error)) {
+      return false;
+    }
+    total = std::move(next);
+  }
+  result = std::move(total);
+  return true;
+}
+
+// min() and max(). Boxed lists are compared with <, so they may hold
+// numbers or strings but not both.
+template <bool kMax>
+bool extreme(const Value* args, Value& result, const char*& error) {
+  if (!args[0].isList()) {
+    error = kListOperand;
+    return false;
+  }
+  const ListObj& list = *args[0].asList();
+  if (list.size() == 0) {
+    error = kEmptyList;
+    return false;
+  }
+  if (list.unboxed()) {
+    const int64_t* data = list.ints().data();
+    result = Value::integer(kMax ? Kernels::max(data, list.size())
+                                 : Kernels::min(data, list.size()));
+    return true;
+  }
+  const std::vector<Value>& values = list.values();
+  Value best = values[0];
+  for (size_t i = 1; i < values.size(); i++) {
+    Value better;
+    if (!Operators::binary(kMax ? Token::TokenType::GREATER
+                                : Token::TokenType::LESS,
+                           values[i], best, better, error)) {
+      return false;
+    }
+    if (better.asBool()) best = values[i];
+  }
+  result = std::move(best);
+  return true;
+}
+
+// Whether v can be handed to a kernel: an unboxed list or an int.
+bool intOperand(const Value& v) {
+  return v.isList() ? v.asList()->unboxed() : v.isInt();
+}
+
+Kernels::Operand operand(const Value& v) {
+  return v.isList() ? Kernels::Operand::array(v.asList()->ints().data())
+                    : Kernels::Operand::scalar(v.asInt());
+}
+
+// add(), subtract() and multiply(): the operator applied pairwise to two
+// lists of the same length, or between every element of a list and a
+// single value. Unboxed operands go to the kernels; anything else, and
+// results the kernels cannot represent, take the per-element path that +
+// - and * use.
+template <Token::TokenType kOp, Kernels::Op kKernel>
+bool elementwise(const Value* args, Value& result, const char*& error) {
+  const Value& a = args[0];
+  const Value& b = args[1];
+  if (!a.isList() && !b.isList()) {
+    error = kListOperands;
+    return false;
+  }
+  const size_t n = a.isList() ? a.asList()->size() : b.asList()->size();
+  if (a.isList() && b.isList() && b.asList()->size() != n) {
+    error = kLengthMismatch;
+    return false;
+  }
+
+  if (intOperand(a) && intOperand(b)) {
+    const Kernels::Operand x = operand(a);
+    const Kernels::Operand y = operand(b);
+    std::vector<int64_t> out(n);
+    if (Kernels::elementwise(kKernel, x, y, out.data(), n)) {
+      result = Value::list(new ListObj(std::move(out)));
+      return true;
+    }
+  }
+
+  ListObj* list = new ListObj();
+  Value owner = Value::list(list);
+  list->reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    Value element;
+    if (!Operators::binary(kOp, a.isList() ? a.asList()->get(i) : a,
+                           b.isList() ? b.asList()->get(i) : b, element,
+                           error)) {
+      return false;
+    }
+    list->append(element);
+  }
+  result = std::move(owner);
+  return true;
+}
+}  // namespace
+
+const std::vector<Builtin>& Builtins::all() {
+  static const std::vector<Builtin> builtins = {
+      {"len", 1, len},
+      {"sum", 1, sum},
+      {"min", 1, extreme<false>},
+      {"max", 1, extreme<true>},
+      {"add", 2, elementwise<Token::TokenType::PLUS, Kernels::Op::ADD>},
+      {"subtract", 2,
+       elementwise<Token::TokenType::MINUS, Kernels::Op::SUBTRACT>},
+      {"multiply", 2,
+       elementwise<Token::TokenType::STAR, Kernels::Op::MULTIPLY>},
+  };
+  return builtins;
+}
+
+const Builtin* Builtins::find(std::string_view name) {
+  for (const Builtin& builtin : all()) {
+    if (name == builtin.name) return &builtin;
+  }
+  return nullptr;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "Value.hpp"
+
+namespace PyInterpreter {
+// A function implemented in C++ and bound as a global before a script runs.
+// Like the Operators, it returns false on a type error and points error at a
+// static message, which the caller reports at the call's line.
+struct Builtin {
+  const char* name;
+  int arity;
+  bool (*function)(const Value* args, Value& result, const char*& error);
+};
+
+namespace Builtins {
+// Every builtin, in a fixed order.
+const std::vector<Builtin>& all();
+// Null if there is no builtin called name.
+const Builtin* find(std::string_view name);
+}  // namespace Builtins
+}  // namespace PyInterpreter
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "PyCallable.hpp"
+#include "Value.hpp"
+
+// Opcode list, expanded into the OpCode enum and the VM dispatch table so the
+// two can never disagree on ordering. Operand widths are noted per opcode.
+#define PY_OPCODES(X)                                         \
+  X(CONSTANT)          /* u16 constant index */               \
+  X(NONE)                                                     \
+  X(TRUE)                                                     \
+  X(FALSE)                                                    \
+  X(POP)                                                      \
+  X(GET_LOCAL)         /* u8 slot */                          \
+  X(SET_LOCAL)         /* u8 slot */                          \
+  X(GET_GLOBAL)        /* u16 global index */                 \
+  X(SET_GLOBAL)        /* u16 global index */                 \
+  X(EQUAL)                                                    \
+  X(NOT_EQUAL)                                                \
+  X(GREATER)                                                  \
+  X(GREATER_EQUAL)                                            \
+  X(LESS)                                                     \
+  X(LESS_EQUAL)                                               \
+  X(ADD)                                                      \
+  X(SUBTRACT)                                                 \
+  X(MULTIPLY)                                                 \
+  X(DIVIDE)                                                   \
+  X(NOT)                                                      \
+  X(NEGATE)                                                   \
+  X(JUMP)              /* u16 forward offset */               \
+  X(JUMP_IF_FALSE)     /* u16 forward offset, keeps operand */ \
+  X(JUMP_IF_TRUE)      /* u16 forward offset, keeps operand */ \
+  X(POP_JUMP_IF_FALSE) /* u16 forward offset */               \
+  X(LOOP)              /* u16 backward offset */              \
+  X(RANGE)             /* checks start, stop, step */         \
+  X(FOR_RANGE)         /* u16 forward offset at the end */    \
+  X(CALL)              /* u8 argument count */                \
+  X(TAIL_CALL)         /* u8 argument count */                \
+  X(BUILD_LIST)        /* u16 element count */                \
+  X(INDEX)                                                    \
+  X(SET_INDEX)         /* value, object, index -> value */    \
+  X(APPEND)                                                   \
+  X(RETURN)                                                   \
+  X(PRINT)                                                    \
+  X(PRINT_LINE)
+
+namespace PyInterpreter {
+enum class OpCode : uint8_t {
+#define PY_OPCODE_ENUM(name) name,
+  PY_OPCODES(PY_OPCODE_ENUM)
+#undef PY_OPCODE_ENUM
+};
+
+class Chunk {
+ public:
+  void write(uint8_t byte, int line) {
+    code.push_back(byte);
+    lines.push_back(line);
+  }
+
+  std::vector<uint8_t> code;
+  std::vector<int> lines;
+  std::vector<Value> constants;
+};
+
+// A function compiled to bytecode. It is only callable from the VM, which
+// sets up its frame directly instead of going through call().
+class BytecodeFunction : public PyCallable {
+ public:
+  BytecodeFunction(const std::string& n, int params)
+      : name(n), numParams(params) {}
+
+  int arity() { return numParams; }
+  Value call(Interpreter*, Value*) {
+    throw std::runtime_error("Bytecode functions can only run on the VM.");
+  }
+  std::string toString() { return "<fn " + name + ">"; }
+
+  const std::string name;
+  const int numParams;
+  int numLocals = 0;
+  int maxStack = 0;
+  Chunk chunk;
+};
+}  // namespace PyInterpreter
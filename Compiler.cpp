@@ -0,0 +1,431 @@
+#include "Compiler.hpp"
+
+#include <stdexcept>
+
+using namespace PyInterpreter;
+
+namespace {
+int stackEffect(OpCode op) {
+  switch (op) {
+    case OpCode::CONSTANT:
+    case OpCode::NONE:
+    case OpCode::TRUE:
+    case OpCode::FALSE:
+    case OpCode::GET_LOCAL:
+    case OpCode::GET_GLOBAL:
+    case OpCode::FOR_RANGE:
+      return 1;
+    case OpCode::POP:
+    case OpCode::EQUAL:
+    case OpCode::NOT_EQUAL:
+    case OpCode::GREATER:
+    case OpCode::GREATER_EQUAL:
+    case OpCode::LESS:
+    case OpCode::LESS_EQUAL:
+    case OpCode::ADD:
+    case OpCode::SUBTRACT:
+    case OpCode::MULTIPLY:
+    case OpCode::DIVIDE:
+    case OpCode::POP_JUMP_IF_FALSE:
+    case OpCode::RETURN:
+    case OpCode::PRINT:
+    case OpCode::INDEX:
+    case OpCode::APPEND:
+      return -1;
+    case OpCode::SET_INDEX:
+      return -2;
+    default:
+      return 0;
+  }
+}
+}  // namespace
+
+std::unique_ptr<CompiledProgram> Compiler::compile(
+    const std::vector<Stmt*>& statements) {
+  std::unique_ptr<CompiledProgram> program(new CompiledProgram());
+  m_program = program.get();
+  m_globals.clear();
+
+  BytecodeFunction* script = new BytecodeFunction("<script>", 0);
+  program->functions.emplace_back(script);
+  program->script = script;
+
+  FunctionState state;
+  state.function = script;
+  m_current = &state;
+  compileStatements(statements);
+  emit(OpCode::NONE);
+  emit(OpCode::RETURN);
+  script->maxStack += 1;
+
+  m_current = nullptr;
+  m_program = nullptr;
+  return program;
+}
+
+void Compiler::compileStatements(const std::vector<Stmt*>& stmts) {
+  for (Stmt* stmt : stmts) stmt->accept(*this);
+}
+
+void Compiler::visit(Assign& expr) {
+  compileExpr(expr.value);
+  m_line = expr.name.line;
+  emitSet(expr.name, expr.slot);
+}
+
+void Compiler::visit(Literal& expr) {
+  switch (expr.value.type()) {
+    case Value::Type::NONE:
+      emit(OpCode::NONE);
+      break;
+    case Value::Type::BOOL:
+      emit(expr.value.asBool() ? OpCode::TRUE : OpCode::FALSE);
+      break;
+    default:
+      emit(OpCode::CONSTANT);
+      emitShort(makeConstant(expr.value));
+      break;
+  }
+}
+
+void Compiler::visit(Logical& expr) {
+  compileExpr(expr.left);
+  int endJump = emitJump(expr.op.type == Token::TokenType::OR
+                             ? OpCode::JUMP_IF_TRUE
+                             : OpCode::JUMP_IF_FALSE);
+  emit(OpCode::POP);
+  compileExpr(expr.right);
+  patchJump(endJump);
+}
+
+void Compiler::visit(Unary& expr) {
+  compileExpr(expr.right);
+  m_line = expr.op.line;
+  emit(expr.op.type == Token::TokenType::BANG ? OpCode::NOT : OpCode::NEGATE);
+}
+
+void Compiler::visit(Variable& expr) {
+  m_line = expr.name.line;
+  emitGet(expr.name, expr.slot);
+}
+
+void Compiler::visit(Grouping& expr) { compileExpr(expr.expression); }
+
+void Compiler::visit(Binary& expr) {
+  compileExpr(expr.left);
+  compileExpr(expr.right);
+  m_line = expr.op.line;
+  switch (expr.op.type) {
+    case Token::TokenType::EQUAL_EQUAL:
+      emit(OpCode::EQUAL);
+      break;
+    case Token::TokenType::BANG_EQUAL:
+      emit(OpCode::NOT_EQUAL);
+      break;
+    case Token::TokenType::GREATER:
+      emit(OpCode::GREATER);
+      break;
+    case Token::TokenType::GREATER_EQUAL:
+      emit(OpCode::GREATER_EQUAL);
+      break;
+    case Token::TokenType::LESS:
+      emit(OpCode::LESS);
+      break;
+    case Token::TokenType::LESS_EQUAL:
+      emit(OpCode::LESS_EQUAL);
+      break;
+    case Token::TokenType::PLUS:
+      emit(OpCode::ADD);
+      break;
+    case Token::TokenType::MINUS:
+      emit(OpCode::SUBTRACT);
+      break;
+    case Token::TokenType::STAR:
+      emit(OpCode::MULTIPLY);
+      break;
+    case Token::TokenType::SLASH:
+      emit(OpCode::DIVIDE);
+      break;
+    default:
+      throw std::runtime_error("Line " + std::to_string(m_line) +
+                               ": Unknown operator.");
+  }
+}
+
+void Compiler::visit(Call& expr) { compileCall(expr, OpCode::CALL); }
+
+void Compiler::compileCall(Call& expr, OpCode op) {
+  compileExpr(expr.callee);
+  for (Expr* arg : expr.arguments) compileExpr(arg);
+  if (expr.arguments.size() > 255) {
+    throw std::runtime_error("Line " + std::to_string(expr.paren.line) +
+                             ": Can't have more than 255 arguments.");
+  }
+  m_line = expr.paren.line;
+  emit(op);
+  emitByte(static_cast<uint8_t>(expr.arguments.size()));
+  adjustStack(-static_cast<int>(expr.arguments.size()));
+}
+
+void Compiler::visit(List& expr) {
+  for (Expr* element : expr.elements) compileExpr(element);
+  if (expr.elements.size() > 0xffff) {
+    throw std::runtime_error("Line " + std::to_string(expr.bracket.line) +
+                             ": Too many elements in a list literal.");
+  }
+  m_line = expr.bracket.line;
+  emit(OpCode::BUILD_LIST);
+  emitShort(expr.elements.size());
+  adjustStack(1 - static_cast<int>(expr.elements.size()));
+}
+
+void Compiler::visit(Index& expr) {
+  compileExpr(expr.object);
+  compileExpr(expr.index);
+  m_line = expr.bracket.line;
+  emit(OpCode::INDEX);
+}
+
+void Compiler::visit(SetIndex& expr) {
+  compileExpr(expr.value);
+  compileExpr(expr.object);
+  compileExpr(expr.index);
+  m_line = expr.bracket.line;
+  emit(OpCode::SET_INDEX);
+}
+
+// APPEND is the only method; it leaves none, the call's result.
+void Compiler::visit(MethodCall& expr) {
+  compileExpr(expr.object);
+  compileExpr(expr.arguments[0]);
+  m_line = expr.name.line;
+  emit(OpCode::APPEND);
+}
+
+void Compiler::visit(Block& stmt) { compileStatements(stmt.statements); }
+
+void Compiler::visit(IfElseBlock& stmt) { compileStatements(stmt.statements); }
+
+void Compiler::visit(Expression& stmt) {
+  compileExpr(stmt.expression);
+  emit(OpCode::POP);
+}
+
+void Compiler::visit(Function& stmt) {
+  m_line = stmt.name.line;
+  BytecodeFunction* function =
+      new BytecodeFunction(std::string(stmt.name.lexeme),
+                           stmt.parameters.size());
+  m_program->functions.emplace_back(function);
+
+  FunctionState state;
+  state.function = function;
+  if (stmt.numLocals > 256) {
+    throw std::runtime_error("Line " + std::to_string(m_line) +
+                             ": Too many local variables in function.");
+  }
+
+  FunctionState* enclosing = m_current;
+  m_current = &state;
+  compileStatements(stmt.body);
+  emit(OpCode::NONE);
+  emit(OpCode::RETURN);
+  function->numLocals = stmt.numLocals;
+  function->maxStack += function->numLocals + 1;
+  m_current = enclosing;
+
+  m_line = stmt.name.line;
+  emit(OpCode::CONSTANT);
+  emitShort(makeConstant(Value::function(function)));
+  emitSet(stmt.name, stmt.slot);
+  emit(OpCode::POP);
+}
+
+void Compiler::visit(If& stmt) {
+  compileExpr(stmt.condition);
+  int elseJump = emitJump(OpCode::POP_JUMP_IF_FALSE);
+  stmt.thenBranch->accept(*this);
+  if (stmt.elseBranch != nullptr) {
+    int endJump = emitJump(OpCode::JUMP);
+    patchJump(elseJump);
+    stmt.elseBranch->accept(*this);
+    patchJump(endJump);
+  } else {
+    patchJump(elseJump);
+  }
+}
+
+void Compiler::visit(ReturnStmt& stmt) {
+  if (stmt.tailCall) {
+    // TAIL_CALL replaces the current frame and never falls through.
+    compileCall(static_cast<Call&>(*stmt.value), OpCode::TAIL_CALL);
+    return;
+  }
+  if (stmt.value != nullptr) {
+    compileExpr(stmt.value);
+  } else {
+    emit(OpCode::NONE);
+  }
+  m_line = stmt.keyword.line;
+  emit(OpCode::RETURN);
+  // Keep the depth balanced for the code that follows in the same block.
+  adjustStack(1);
+}
+
+void Compiler::visit(Print& stmt) {
+  for (Expr* expr : stmt.expressions) {
+    compileExpr(expr);
+    emit(OpCode::PRINT);
+  }
+  emit(OpCode::PRINT_LINE);
+}
+
+void Compiler::visit(Var& stmt) {
+  if (stmt.initializer != nullptr) {
+    compileExpr(stmt.initializer);
+  } else {
+    emit(OpCode::NONE);
+  }
+  m_line = stmt.name.line;
+  emitSet(stmt.name, stmt.slot);
+  emit(OpCode::POP);
+}
+
+void Compiler::visit(While& stmt) {
+  const int start = m_current->function->chunk.code.size();
+  compileExpr(stmt.condition);
+  int exitJump = emitJump(OpCode::POP_JUMP_IF_FALSE);
+  compileStatements(stmt.body);
+  emitLoop(start);
+  patchJump(exitJump);
+}
+
+void Compiler::visit(For& stmt) {
+  // The counter, stop and step stay on the stack for the whole loop.
+  if (stmt.start != nullptr) {
+    compileExpr(stmt.start);
+  } else {
+    emit(OpCode::CONSTANT);
+    emitShort(makeConstant(Value::integer(0)));
+  }
+  compileExpr(stmt.stop);
+  if (stmt.step != nullptr) {
+    compileExpr(stmt.step);
+  } else {
+    emit(OpCode::CONSTANT);
+    emitShort(makeConstant(Value::integer(1)));
+  }
+  m_line = stmt.range.line;
+  emit(OpCode::RANGE);
+
+  const int start = m_current->function->chunk.code.size();
+  int exitJump = emitJump(OpCode::FOR_RANGE);
+  m_line = stmt.name.line;
+  emitSet(stmt.name, stmt.slot);
+  emit(OpCode::POP);
+  compileStatements(stmt.body);
+  emitLoop(start);
+  patchJump(exitJump);
+  // FOR_RANGE drops all three when the range is exhausted.
+  adjustStack(-3);
+}
+
+void Compiler::emit(OpCode op) {
+  emitByte(static_cast<uint8_t>(op));
+  adjustStack(stackEffect(op));
+}
+
+void Compiler::emitByte(uint8_t byte) {
+  m_current->function->chunk.write(byte, m_line);
+}
+
+void Compiler::emitShort(int value) {
+  emitByte((value >> 8) & 0xff);
+  emitByte(value & 0xff);
+}
+
+int Compiler::emitJump(OpCode op) {
+  emit(op);
+  emitShort(0xffff);
+  return m_current->function->chunk.code.size() - 2;
+}
+
+void Compiler::patchJump(int offset) {
+  std::vector<uint8_t>& code = m_current->function->chunk.code;
+  int jump = code.size() - offset - 2;
+  if (jump > 0xffff) {
+    throw std::runtime_error("Line " + std::to_string(m_line) +
+                             ": Too much code to jump over.");
+  }
+  code[offset] = (jump >> 8) & 0xff;
+  code[offset + 1] = jump & 0xff;
+}
+
+void Compiler::emitLoop(int start) {
+  emit(OpCode::LOOP);
+  int offset = m_current->function->chunk.code.size() - start + 2;
+  if (offset > 0xffff) {
+    throw std::runtime_error("Line " + std::to_string(m_line) +
+                             ": Loop body too large.");
+  }
+  emitShort(offset);
+}
+
+void Compiler::adjustStack(int delta) {
+  m_current->stackDepth += delta;
+  int& maxStack = m_current->function->maxStack;
+  if (m_current->stackDepth > maxStack) maxStack = m_current->stackDepth;
+}
+
+int Compiler::makeConstant(const Value& value) {
+  std::vector<Value>& constants = m_current->function->chunk.constants;
+  if (value.isInt()) {
+    auto found = m_current->intConstants.find(value.asInt());
+    if (found != m_current->intConstants.end()) return found->second;
+  } else if (value.isString()) {
+    auto found = m_current->stringConstants.find(value.asString());
+    if (found != m_current->stringConstants.end()) return found->second;
+  }
+  if (constants.size() > 0xffff) {
+    throw std::runtime_error("Line " + std::to_string(m_line) +
+                             ": Too many constants in one chunk.");
+  }
+  int index = constants.size();
+  constants.push_back(value);
+  if (value.isInt()) m_current->intConstants[value.asInt()] = index;
+  if (value.isString()) m_current->stringConstants[value.asString()] = index;
+  return index;
+}
+
+int Compiler::globalSlot(Symbol name) {
+  auto found = m_globals.find(name);
+  if (found != m_globals.end()) return found->second;
+  if (m_globals.size() > 0xffff) {
+    throw std::runtime_error("Line " + std::to_string(m_line) +
+                             ": Too many global variables.");
+  }
+  int index = m_globals.size();
+  m_globals[name] = index;
+  m_program->globalNames.emplace_back(SymbolTable::instance().name(name));
+  return index;
+}
+
+void Compiler::emitGet(const Token& name, int slot) {
+  if (slot >= 0) {
+    emit(OpCode::GET_LOCAL);
+    emitByte(static_cast<uint8_t>(slot));
+  } else {
+    emit(OpCode::GET_GLOBAL);
+    emitShort(globalSlot(name.symbol));
+  }
+}
+
+void Compiler::emitSet(const Token& name, int slot) {
+  if (slot >= 0) {
+    emit(OpCode::SET_LOCAL);
+    emitByte(static_cast<uint8_t>(slot));
+  } else {
+    emit(OpCode::SET_GLOBAL);
+    emitShort(globalSlot(name.symbol));
+  }
+}
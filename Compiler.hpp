@@ -0,0 +1,81 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Chunk.hpp"
+#include "Expr.hpp"
+#include "Stmt.hpp"
+#include "SymbolTable.hpp"
+
+namespace PyInterpreter {
+struct CompiledProgram {
+  BytecodeFunction* script = nullptr;
+  std::vector<std::unique_ptr<BytecodeFunction>> functions;
+  std::vector<std::string> globalNames;
+};
+
+// Lowers resolved statements to bytecode for the VM. Names the Resolver gave a
+// frame slot become local accesses; every other name is a global bound to a
+// fixed index at compile time.
+class Compiler : public Expr::Visitor, public Stmt::Visitor {
+ public:
+  std::unique_ptr<CompiledProgram> compile(const std::vector<Stmt*>& statements);
+
+  void visit(Assign& expr);
+  void visit(Literal& expr);
+  void visit(Logical& expr);
+  void visit(Unary& expr);
+  void visit(Variable& expr);
+  void visit(Grouping& expr);
+  void visit(Binary& expr);
+  void visit(Call& expr);
+  void visit(List& expr);
+  void visit(Index& expr);
+  void visit(SetIndex& expr);
+  void visit(MethodCall& expr);
+
+  void visit(Block& stmt);
+  void visit(IfElseBlock& stmt);
+  void visit(Expression& stmt);
+  void visit(Function& stmt);
+  void visit(If& stmt);
+  void visit(ReturnStmt& stmt);
+  void visit(Print& stmt);
+  void visit(Var& stmt);
+  void visit(While& stmt);
+  void visit(For& stmt);
+
+ private:
+  struct FunctionState {
+    BytecodeFunction* function;
+    std::unordered_map<int64_t, int> intConstants;
+    std::unordered_map<std::string, int> stringConstants;
+    int stackDepth = 0;
+  };
+
+  void compileStatements(const std::vector<Stmt*>& stmts);
+  void compileExpr(Expr* expr) { expr->accept(*this); }
+  void compileCall(Call& expr, OpCode op);
+
+  void emit(OpCode op);
+  void emitByte(uint8_t byte);
+  void emitShort(int value);
+  int emitJump(OpCode op);
+  void patchJump(int offset);
+  void emitLoop(int start);
+  void adjustStack(int delta);
+
+  int makeConstant(const Value& value);
+  int globalSlot(Symbol name);
+  void emitGet(const Token& name, int slot);
+  void emitSet(const Token& name, int slot);
+
+  FunctionState* m_current = nullptr;
+  CompiledProgram* m_program = nullptr;
+  std::unordered_map<Symbol, int> m_globals;
+  int m_line = 0;
+};
+}  // namespace PyInterpreter
@@ -2,34 +2,27 @@
 
 using namespace PyInterpreter;
 
-std::string Environment::get(Token name) {
-  if (m_values.find(name.lexeme) != m_values.end()) {
-    return m_values[name.lexeme];
+void Environment::assign(Symbol symbol, const Value& value) {
+  size_t index = find(symbol);
+  if (m_slots[index].symbol == 0) {
+    if ((m_count + 1) * 2 > m_slots.size()) {
+      grow();
+      index = find(symbol);
+    }
+    m_slots[index].symbol = symbol;
+    m_count++;
   }
-  if (enclosing != nullptr) {
-    return enclosing->get(name);
-  }
-  if (m_functions.find(name.lexeme) != m_functions.end()) {
-    return name.lexeme;
-  }
-  throw new std::runtime_error("Line " + std::to_string(name.line) +
-                               ": Undefined variable " + name.lexeme + ".");
+  m_slots[index].value = value;
 }
 
-PyFunction* Environment::getFunction(std::string name) {
-  if (m_functions.find(name) != m_functions.end()) {
-    return m_functions[name];
-  }
-  if (enclosing != nullptr) {
-    return enclosing->getFunction(name);
+void Environment::grow() {
+  std::vector<Slot> slots(m_slots.size() * 2);
+  m_slots.swap(slots);
+  m_version++;
+  for (Slot& slot : slots) {
+    if (slot.symbol == 0) continue;
+    Slot& moved = m_slots[find(slot.symbol)];
+    moved.symbol = slot.symbol;
+    moved.value = std::move(slot.value);
   }
-  throw new std::runtime_error("Undefined function " + name + ".");
 }
-
-void Environment::assign(Token name, std::string value) {
-  m_values[name.lexeme] = value;
-}
-
-void Environment::assignFunction(Token name, PyFunction* func) {
-  m_functions[name.lexeme] = func;
-}
\ No newline at end of file
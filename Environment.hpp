@@ -1,27 +1,58 @@
 #pragma once
 
-#include <stdexcept>
-#include <string>
-#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
-#include "Token.hpp"
-#include "PyCallable.hpp"
+#include "SymbolTable.hpp"
+#include "Value.hpp"
 
 namespace PyInterpreter {
-class PyFunction;
+// Global namespace: one flat open-addressing table keyed by interned symbol,
+// shared by variables and functions. Function locals never reach it: the
+// Resolver gives them frame slots that the interpreter indexes directly.
 class Environment {
  public:
-  Environment() : enclosing(nullptr){};
-  Environment(Environment* encl) : enclosing(encl){};
-  std::string get(Token name);
-  PyFunction* getFunction(std::string name);
-  void assign(Token name, std::string value);
-  void assignFunction(Token name, PyFunction* func);
+  Environment() : m_slots(64) {}
 
-  Environment* enclosing;
+  // Returns false if symbol is not bound.
+  bool get(Symbol symbol, Value& value) const {
+    const Slot& slot = m_slots[find(symbol)];
+    if (slot.symbol == 0) return false;
+    value = slot.value;
+    return true;
+  }
+  void assign(Symbol symbol, const Value& value);
+
+  // The value bound to symbol, or null. The pointer stays valid, tracking
+  // later assignments, until version() changes.
+  Value* lookup(Symbol symbol) {
+    Slot& slot = m_slots[find(symbol)];
+    return slot.symbol == 0 ? nullptr : &slot.value;
+  }
+  // Changes whenever the table is rehashed and its values move.
+  uint32_t version() const { return m_version; }
 
  private:
-  std::unordered_map<std::string, std::string> m_values;
-  std::unordered_map<std::string, PyFunction*> m_functions;
+  struct Slot {
+    Symbol symbol = 0;
+    Value value;
+  };
+
+  // Index of symbol's slot, or of the empty slot where it would go.
+  size_t find(Symbol symbol) const {
+    const size_t mask = m_slots.size() - 1;
+    // Fibonacci hashing spreads the dense symbol ids over the table.
+    size_t i = (symbol * 0x9E3779B97F4A7C15ull) >> 32 & mask;
+    while (m_slots[i].symbol != symbol && m_slots[i].symbol != 0) {
+      i = (i + 1) & mask;
+    }
+    return i;
+  }
+  void grow();
+
+  std::vector<Slot> m_slots;
+  size_t m_count = 0;
+  uint32_t m_version = 0;
 };
-}  // namespace PyInterpreter
\ No newline at end of file
+}  // namespace PyInterpreter
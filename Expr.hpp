@@ -1,8 +1,11 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 
 #include "Token.hpp"
+#include "Value.hpp"
 
 #define MAKE_VISITABLE_EXPR \
   void accept(Expr::Visitor& vis) override { vis.visit(*this); }
@@ -16,6 +19,52 @@ class Logical;
 class Unary;
 class Call;
 class Variable;
+class List;
+class Index;
+class SetIndex;
+class MethodCall;
+
+// The operation a Binary, Unary or Logical site has settled on, recorded by
+// the tree interpreter from the operand types it sees. A site starts COLD,
+// switches to the variant for its operator once enough executions all saw
+// ints (or bools), and falls back to GENERIC for good when a guard fails or
+// the operands were of any other kind. Every value after GENERIC is a
+// specialized variant.
+enum class Specialization : uint8_t {
+  COLD,
+  GENERIC,
+  INT_ADD,
+  INT_SUBTRACT,
+  INT_MULTIPLY,
+  INT_DIVIDE,
+  INT_EQUAL,
+  INT_NOT_EQUAL,
+  INT_LESS,
+  INT_LESS_EQUAL,
+  INT_GREATER,
+  INT_GREATER_EQUAL,
+  INT_NEGATE,
+  BOOL_NOT,
+  BOOL_AND,
+  BOOL_OR
+};
+
+// Operands a specialized Binary reads in place rather than visiting: a
+// local variable on the left, a literal on the right.
+const uint8_t kLocalLeftOperand = 1;
+const uint8_t kLiteralRightOperand = 2;
+
+// Per-node specialization state. The fields are relaxed atomics because a
+// parsed program may be run by several threads at once; a lost update only
+// delays a transition.
+struct SpecializationState {
+  std::atomic<Specialization> variant{Specialization::COLD};
+  // Executions observed while COLD.
+  std::atomic<uint8_t> warmup{0};
+  // k*Operand flags, fixed by the shape of the tree, so a thread that sees
+  // them late merely visits the operands.
+  std::atomic<uint8_t> operands{0};
+};
 
 class Expr {
  public:
@@ -29,6 +78,10 @@ class Expr {
     virtual void visit(Variable& expr) = 0;
     virtual void visit(Binary& expr) = 0;
     virtual void visit(Call& expr) = 0;
+    virtual void visit(List& expr) = 0;
+    virtual void visit(Index& expr) = 0;
+    virtual void visit(SetIndex& expr) = 0;
+    virtual void visit(MethodCall& expr) = 0;
   };
 
   virtual void accept(Visitor& visitor) = 0;
@@ -41,14 +94,16 @@ class Assign : public Expr {
 
   Token name;
   Expr* value;
+  // Frame slot assigned by the Resolver; -1 for globals.
+  int slot = -1;
 };
 
 class Literal : public Expr {
  public:
-  Literal(std::string val) : value(val) {}
+  Literal(Value val) : value(val) {}
   MAKE_VISITABLE_EXPR
 
-  std::string value;
+  Value value;
 };
 
 class Logical : public Expr {
@@ -59,6 +114,7 @@ class Logical : public Expr {
   Expr* left;
   Token op;
   Expr* right;
+  SpecializationState specialization;
 };
 
 class Unary : public Expr {
@@ -68,6 +124,7 @@ class Unary : public Expr {
 
   Token op;
   Expr* right;
+  SpecializationState specialization;
 };
 
 class Variable : public Expr {
@@ -76,6 +133,11 @@ class Variable : public Expr {
   MAKE_VISITABLE_EXPR
 
   Token name;
+  // Frame slot assigned by the Resolver; -1 for globals.
+  int slot = -1;
+  // For globals, this site's entry in the interpreter's global cache, also
+  // assigned by the Resolver; -1 if the site is uncached.
+  int cache = -1;
 };
 
 class Grouping : public Expr {
@@ -94,6 +156,7 @@ class Binary : public Expr {
   Expr* left;
   Token op;
   Expr* right;
+  SpecializationState specialization;
 };
 
 class Call : public Expr {
@@ -105,5 +168,57 @@ class Call : public Expr {
   Expr* callee;
   Token paren;
   std::vector<Expr*> arguments;
+  // callee, when the Resolver found it to be a cached global read. Only
+  // trusted while callee still points to it, since -O may replace callee.
+  Variable* global = nullptr;
+};
+
+// A list literal; each evaluation creates a new list.
+class List : public Expr {
+ public:
+  List(Token b, std::vector<Expr*> elems) : bracket(b), elements(elems) {}
+  MAKE_VISITABLE_EXPR
+
+  Token bracket;
+  std::vector<Expr*> elements;
+};
+
+class Index : public Expr {
+ public:
+  Index(Expr* obj, Token b, Expr* idx) : object(obj), bracket(b), index(idx) {}
+  MAKE_VISITABLE_EXPR
+
+  Expr* object;
+  Token bracket;
+  Expr* index;
+};
+
+// object[index] = value. As in Python, value is evaluated first.
+class SetIndex : public Expr {
+ public:
+  SetIndex(Expr* obj, Token b, Expr* idx, Expr* val)
+      : object(obj), bracket(b), index(idx), value(val) {}
+  MAKE_VISITABLE_EXPR
+
+  Expr* object;
+  Token bracket;
+  Expr* index;
+  Expr* value;
+};
+
+// object.name(arguments). The parser only accepts the methods listed in
+// Method, so each engine can dispatch on it without a lookup.
+class MethodCall : public Expr {
+ public:
+  enum class Method : uint8_t { APPEND };
+
+  MethodCall(Expr* obj, Token n, Method m, std::vector<Expr*> args)
+      : object(obj), name(n), method(m), arguments(args) {}
+  MAKE_VISITABLE_EXPR
+
+  Expr* object;
+  Token name;
+  Method method;
+  std::vector<Expr*> arguments;
 };
 }  // namespace PyInterpreter
\ No newline at end of file
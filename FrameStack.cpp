@@ -0,0 +1,35 @@
+#include "FrameStack.hpp"
+
+using namespace PyInterpreter;
+
+FrameStack::FrameStack() {
+  m_segments.push_back({std::unique_ptr<Value[]>(new Value[kSegmentSize]),
+                        kSegmentSize, nullptr});
+  m_top = m_segments[0].values.get();
+  m_end = m_top + kSegmentSize;
+}
+
+void FrameStack::nextSegment(size_t count) {
+  // The unused tail of the current segment is skipped and stays none.
+  m_segments[m_segment].resumeTop = m_top;
+  m_segment++;
+  if (m_segment < m_segments.size() && m_segments[m_segment].size < count) {
+    m_segments.resize(m_segment);
+  }
+  if (m_segment == m_segments.size()) {
+    size_t size = count > kSegmentSize ? count : kSegmentSize;
+    m_segments.push_back(
+        {std::unique_ptr<Value[]>(new Value[size]), size, nullptr});
+  }
+  m_top = m_segments[m_segment].values.get();
+  m_end = m_top + m_segments[m_segment].size;
+}
+
+void FrameStack::previousSegment() {
+  Value* begin = m_segments[m_segment].values.get();
+  while (m_top != begin) *--m_top = Value();
+  m_segment--;
+  Segment& previous = m_segments[m_segment];
+  m_end = previous.values.get() + previous.size;
+  m_top = previous.resumeTop;
+}
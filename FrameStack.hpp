@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "Value.hpp"
+
+namespace PyInterpreter {
+// Value stack that holds the slots of every active call. A call allocates
+// its frame contiguously on top and releases it on return; frames never move
+// once allocated, so the interpreter can keep raw pointers to them. Storage
+// is one preallocated segment, with more chained on only for very deep
+// recursion. Every slot above the top is none.
+class FrameStack {
+ public:
+  struct Mark {
+    size_t segment;
+    Value* top;
+  };
+
+  FrameStack();
+
+  Mark mark() const { return {m_segment, m_top}; }
+
+  // Returns count contiguous none slots.
+  Value* allocate(size_t count) {
+    if (static_cast<size_t>(m_end - m_top) < count) nextSegment(count);
+    Value* frame = m_top;
+    m_top += count;
+    return frame;
+  }
+
+  // Drops everything allocated since mark, resetting the slots to none.
+  void release(const Mark& mark) {
+    while (m_segment != mark.segment) previousSegment();
+    while (m_top != mark.top) *--m_top = Value();
+  }
+
+ private:
+  struct Segment {
+    std::unique_ptr<Value[]> values;
+    size_t size;
+    // Top of this segment when allocation moved on to the next one.
+    Value* resumeTop;
+  };
+
+  static const size_t kSegmentSize = 1 << 16;
+
+  void nextSegment(size_t count);
+  void previousSegment();
+
+  std::vector<Segment> m_segments;
+  size_t m_segment = 0;
+  Value* m_top = nullptr;
+  Value* m_end = nullptr;
+};
+}  // namespace PyInterpreter
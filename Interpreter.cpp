@@ -1,147 +1,544 @@
 #include "Interpreter.hpp"
 
+#include <algorithm>
+#include <iterator>
+
+#include "Jit.hpp"
+
 using namespace PyInterpreter;
 
-Environment Interpreter::m_environment = Environment();
+namespace {
+// Executions a COLD site must see with the same operand types before it is
+// specialized, so code that runs once never pays for the transition.
+const uint8_t kSpecializeAfter = 8;
+
+Specialization intVariant(Token::TokenType op) {
+  switch (op) {
+    case Token::TokenType::PLUS:
+      return Specialization::INT_ADD;
+    case Token::TokenType::MINUS:
+      return Specialization::INT_SUBTRACT;
+    case Token::TokenType::STAR:
+      return Specialization::INT_MULTIPLY;
+    case Token::TokenType::SLASH:
+      return Specialization::INT_DIVIDE;
+    case Token::TokenType::EQUAL_EQUAL:
+      return Specialization::INT_EQUAL;
+    case Token::TokenType::BANG_EQUAL:
+      return Specialization::INT_NOT_EQUAL;
+    case Token::TokenType::LESS:
+      return Specialization::INT_LESS;
+    case Token::TokenType::LESS_EQUAL:
+      return Specialization::INT_LESS_EQUAL;
+    case Token::TokenType::GREATER:
+      return Specialization::INT_GREATER;
+    case Token::TokenType::GREATER_EQUAL:
+      return Specialization::INT_GREATER_EQUAL;
+    default:
+      return Specialization::GENERIC;
+  }
+}
+
+// Records one execution of a COLD site whose operands fit variant, or
+// GENERIC if they fit none. Returns true once the site is specialized.
+bool observe(SpecializationState& state, Specialization variant) {
+  if (variant == Specialization::GENERIC) {
+    state.variant.store(Specialization::GENERIC, std::memory_order_relaxed);
+    return false;
+  }
+  const uint8_t seen = state.warmup.load(std::memory_order_relaxed) + 1;
+  state.warmup.store(seen, std::memory_order_relaxed);
+  if (seen < kSpecializeAfter) return false;
+  state.variant.store(variant, std::memory_order_relaxed);
+  return true;
+}
+
+// The int variants of Binary. Returns false when the result needs the
+// generic path: a BigInt, or a division error to report.
+bool intBinary(Specialization variant, int64_t a, int64_t b, Value& result) {
+  int64_t value;
+  switch (variant) {
+    case Specialization::INT_ADD:
+      if (__builtin_add_overflow(a, b, &value)) return false;
+      break;
+    case Specialization::INT_SUBTRACT:
+      if (__builtin_sub_overflow(a, b, &value)) return false;
+      break;
+    case Specialization::INT_MULTIPLY:
+      if (__builtin_mul_overflow(a, b, &value)) return false;
+      break;
+    case Specialization::INT_DIVIDE:
+      if (b == 0 || (a == INT64_MIN && b == -1)) return false;
+      value = a / b;
+      break;
+    case Specialization::INT_EQUAL:
+      result = Value::boolean(a == b);
+      return true;
+    case Specialization::INT_NOT_EQUAL:
+      result = Value::boolean(a != b);
+      return true;
+    case Specialization::INT_LESS:
+      result = Value::boolean(a < b);
+      return true;
+    case Specialization::INT_LESS_EQUAL:
+      result = Value::boolean(a <= b);
+      return true;
+    case Specialization::INT_GREATER:
+      result = Value::boolean(a > b);
+      return true;
+    case Specialization::INT_GREATER_EQUAL:
+      result = Value::boolean(a >= b);
+      return true;
+    default:
+      return false;
+  }
+  result = Value::integer(value);
+  return true;
+}
+}  // namespace
 
 void Interpreter::visit(Assign& expr) {
-  std::string val = evaluate(expr.value);
-  m_environment.assign(expr.name, val);
+  Value val = evaluate(expr.value);
+  if (failed()) return Return(Value());
+  if (expr.slot >= 0) {
+    m_frame[expr.slot] = val;
+  } else {
+    m_globals.assign(expr.name.symbol, val);
+  }
   Return(val);
 }
 
 void Interpreter::visit(Literal& expr) { Return(expr.value); }
 
 void Interpreter::visit(Logical& expr) {
-  std::string left = evaluate(expr.left);
+  Value left = evaluate(expr.left);
+  if (failed()) return Return(Value());
+
+  SpecializationState& state = expr.specialization;
+  const Specialization variant = state.variant.load(std::memory_order_relaxed);
+  if (variant > Specialization::GENERIC) {
+    if (left.isBool()) {
+      if (left.asBool() == (variant == Specialization::BOOL_OR)) {
+        return Return(left);
+      }
+      return Return(evaluate(expr.right));
+    }
+    state.variant.store(Specialization::GENERIC, std::memory_order_relaxed);
+  } else if (variant == Specialization::COLD) {
+    const bool isOr = expr.op.type == Token::TokenType::OR;
+    observe(state, !left.isBool() ? Specialization::GENERIC
+                   : isOr         ? Specialization::BOOL_OR
+                                  : Specialization::BOOL_AND);
+  }
 
   if (expr.op.type == Token::TokenType::OR) {
-    if (isTruthy(left)) Return(left);
-  } else if (!isTruthy(left))
-    Return(left);
+    if (isTruthy(left)) return Return(left);
+  } else if (!isTruthy(left)) {
+    return Return(left);
+  }
 
   Return(evaluate(expr.right));
 }
 
 void Interpreter::visit(Unary& expr) {
-  std::string right = evaluate(expr.right);
+  Value right = evaluate(expr.right);
+  if (failed()) return Return(Value());
+
+  SpecializationState& state = expr.specialization;
+  const Specialization variant = state.variant.load(std::memory_order_relaxed);
+  if (variant == Specialization::INT_NEGATE && right.isInt()) {
+    if (right.asInt() != INT64_MIN) {
+      return Return(Value::integer(-right.asInt()));
+    }
+  } else if (variant == Specialization::BOOL_NOT && right.isBool()) {
+    return Return(Value::boolean(!right.asBool()));
+  } else if (variant > Specialization::GENERIC) {
+    state.variant.store(Specialization::GENERIC, std::memory_order_relaxed);
+  } else if (variant == Specialization::COLD) {
+    const bool bang = expr.op.type == Token::TokenType::BANG;
+    observe(state, bang && right.isBool()    ? Specialization::BOOL_NOT
+                   : !bang && right.isInt() ? Specialization::INT_NEGATE
+                                            : Specialization::GENERIC);
+  }
 
-  if (expr.op.type == Token::TokenType::BANG) {
-    Return(std::to_string(!isTruthy(right)));
-  } else if (expr.op.type == Token::TokenType::MINUS) {
-    checkNumberOperand(expr.op, right);
-    Return(std::to_string(-std::stoi(right)));
+  Value result;
+  const char* error;
+  if (!Operators::unary(expr.op.type, right, result, error)) {
+    return runtimeError(expr.op.line, error);
   }
+  Return(result);
 }
 
 void Interpreter::visit(Variable& expr) {
-  Return(m_environment.get(expr.name));
+  if (expr.slot >= 0) return Return(m_frame[expr.slot]);
+  const Value* value = readGlobal(expr);
+  Return(value != nullptr ? *value : Value());
+}
+
+const Value* Interpreter::lookupGlobal(Variable& expr) {
+  Value* value = m_globals.lookup(expr.name.symbol);
+  if (value == nullptr) {
+    runtimeError(expr.name.line,
+                 "Undefined variable " + std::string(expr.name.lexeme) + ".");
+    return nullptr;
+  }
+  // Unbound names are never cached, since binding one may not rehash.
+  if (expr.cache >= 0) {
+    if (static_cast<size_t>(expr.cache) >= m_globalCache.size()) {
+      m_globalCache.resize(expr.cache + 1);
+    }
+    m_globalCache[expr.cache] = {value, m_globals.version()};
+  }
+  return value;
 }
 
 void Interpreter::visit(Grouping& expr) { Return(evaluate(expr.expression)); }
 
 void Interpreter::visit(Binary& expr) {
-  std::string left = evaluate(expr.left);
-  std::string right = evaluate(expr.right);
+  SpecializationState& state = expr.specialization;
+  Specialization variant = state.variant.load(std::memory_order_relaxed);
+  const uint8_t operands = variant > Specialization::GENERIC
+                               ? state.operands.load(std::memory_order_relaxed)
+                               : 0;
+
+  Value left = operands & kLocalLeftOperand
+                   ? m_frame[static_cast<Variable*>(expr.left)->slot]
+                   : evaluate(expr.left);
+  if (failed()) return Return(Value());
+  Value right = operands & kLiteralRightOperand
+                    ? static_cast<Literal*>(expr.right)->value
+                    : evaluate(expr.right);
+  if (failed()) return Return(Value());
+  // The operands may have run this node again, as in 1 + depth(n - 1), and
+  // specialized it meanwhile; a stale COLD would observe it once per
+  // pending frame.
+  if (variant == Specialization::COLD) {
+    variant = state.variant.load(std::memory_order_relaxed);
+  }
 
-  switch (expr.op.type) {
-    case Token::TokenType::GREATER:
-      checkNumberOrStringOperands(expr.op, left, right);
-      if (isNumber(left))
-        Return(std::stoi(left) > std::stoi(right) ? "true" : "false");
-      else
-        Return(left > right ? "true" : "false");
-      break;
-    case Token::TokenType::GREATER_EQUAL:
-      checkNumberOrStringOperands(expr.op, left, right);
-      if (isNumber(left))
-        Return(std::stoi(left) >= std::stoi(right) ? "true" : "false");
-      else
-        Return(left >= right ? "true" : "false");
-      break;
-    case Token::TokenType::LESS:
-      checkNumberOrStringOperands(expr.op, left, right);
-      if (isNumber(left))
-        Return(std::stoi(left) < std::stoi(right) ? "true" : "false");
-      else
-        Return(left < right ? "true" : "false");
-      break;
-    case Token::TokenType::LESS_EQUAL:
-      checkNumberOrStringOperands(expr.op, left, right);
-      if (isNumber(left))
-        Return(std::stoi(left) <= std::stoi(right) ? "true" : "false");
-      else
-        Return(left <= right ? "true" : "false");
-      break;
-    case Token::TokenType::MINUS:
-      checkNumberOperands(expr.op, left, right);
-      Return(std::to_string(std::stoi(left) - std::stoi(right)));
-      break;
-    case Token::TokenType::BANG_EQUAL:
-      Return(left != right ? "true" : "false");
-      break;
-    case Token::TokenType::EQUAL_EQUAL:
-      Return(left == right ? "true" : "false");
-      break;
-    case Token::TokenType::PLUS:
-      if (isNumber(left) && isNumber(right)) {
-        Return(std::to_string(std::stoi(left) + std::stoi(right)));
-      } else {
-        Return(left + right);
+  const bool ints = left.isInt() && right.isInt();
+  Value result;
+  if (variant > Specialization::GENERIC) {
+    if (ints) {
+      if (intBinary(variant, left.asInt(), right.asInt(), result)) {
+        return Return(result);
       }
-      break;
-    case Token::TokenType::SLASH:
-      checkNumberOperands(expr.op, left, right);
-      Return(std::to_string(std::stoi(left) / std::stoi(right)));
-      break;
-    case Token::TokenType::STAR:
-      checkNumberOperands(expr.op, left, right);
-      Return(std::to_string(std::stoi(left) * std::stoi(right)));
-      break;
+    } else {
+      state.variant.store(Specialization::GENERIC, std::memory_order_relaxed);
+    }
+  } else if (variant == Specialization::COLD &&
+             observe(state, ints ? intVariant(expr.op.type)
+                                 : Specialization::GENERIC)) {
+    const Variable* local = dynamic_cast<Variable*>(expr.left);
+    state.operands.store(
+        (local != nullptr && local->slot >= 0 ? kLocalLeftOperand : 0) |
+            (dynamic_cast<Literal*>(expr.right) != nullptr
+                 ? kLiteralRightOperand
+                 : 0),
+        std::memory_order_relaxed);
+  }
+
+  const char* error;
+  if (!Operators::binary(expr.op.type, left, right, result, error)) {
+    return runtimeError(expr.op.line, error);
   }
+  Return(result);
 }
 
 void Interpreter::visit(Call& expr) {
-  const std::string callee = evaluate(expr.callee);
+  Value callee;
+  if (expr.global != nullptr && expr.global == expr.callee) {
+    const Value* global = readGlobal(*expr.global);
+    if (global == nullptr) return;
+    callee = *global;
+  } else {
+    callee = evaluate(expr.callee);
+    if (failed()) return Return(Value());
+  }
 
-  std::vector<std::string> arguments;
-  for (Expr* arg : expr.arguments) {
-    arguments.push_back(evaluate(arg));
+  // Arguments are evaluated straight into the callee's frame.
+  PyCallable* function = callee.isFunction() ? callee.asFunction() : nullptr;
+  const int argc = expr.arguments.size();
+  int frameSize = function != nullptr ? function->frameSize() : 0;
+  if (frameSize < argc) frameSize = argc;
+
+  const FrameStack::Mark mark = m_stack.mark();
+  Value* frame = m_stack.allocate(frameSize);
+  for (int i = 0; i < argc; i++) {
+    frame[i] = evaluate(expr.arguments[i]);
+    if (failed()) {
+      m_stack.release(mark);
+      return Return(Value());
+    }
   }
 
-  Return(m_environment.getFunction(callee)->call(this, arguments));
+  if (function == nullptr) {
+    Value result;
+    if (callee.isBuiltin()) {
+      result = callBuiltin(*callee.asBuiltin(), frame, argc, expr.paren.line);
+    } else {
+      runtimeError(expr.paren.line, "Can only call functions.");
+    }
+    m_stack.release(mark);
+    return Return(result);
+  }
+  if (argc != function->arity()) {
+    m_stack.release(mark);
+    return runtimeError(expr.paren.line,
+                        "Expected " + std::to_string(function->arity()) +
+                            " arguments but got " + std::to_string(argc) +
+                            ".");
+  }
+
+  Return(invoke(function, frame, mark, expr.paren.line));
 }
 
-void Interpreter::interpret(std::vector<Stmt*> statements) {
-  try {
-    for (Stmt* stmt : statements) {
-      execute(stmt);
+void Interpreter::defineBuiltins() {
+  for (const Builtin& builtin : Builtins::all()) {
+    m_globals.assign(SymbolTable::instance().intern(builtin.name),
+                     Value::builtin(&builtin));
+  }
+}
+
+Value Interpreter::callBuiltin(const Builtin& builtin, const Value* args,
+                               int argc, int line) {
+  if (argc != builtin.arity) {
+    runtimeError(line, "Expected " + std::to_string(builtin.arity) +
+                           " arguments but got " + std::to_string(argc) +
+                           ".");
+    return Value();
+  }
+  Value result;
+  const char* error;
+  if (!builtin.function(args, result, error)) {
+    runtimeError(line, error);
+    return Value();
+  }
+  return result;
+}
+
+Value Interpreter::invoke(PyCallable* function, Value* frame,
+                          const FrameStack::Mark& mark, int line) {
+  if (m_depth == m_maxDepth) {
+    m_stack.release(mark);
+    runtimeError(line, "Maximum recursion depth exceeded.");
+    return Value();
+  }
+  m_depth++;
+  if (m_profiler != nullptr) m_profiler->enter(function);
+
+  // A failing callee leaves ERROR set and returns none.
+  Value result;
+  m_nativeStack.maybeGrow([&] { result = function->call(this, frame); });
+  // A tail call from the callee runs here, in the frame it returned from.
+  while (m_completion == Completion::TAIL_CALL) {
+    m_completion = Completion::NORMAL;
+    function = m_tailCallee;
+    m_stack.release(mark);
+    const int tailArgc = m_tailArgs.size();
+    frame = m_stack.allocate(std::max(tailArgc, function->frameSize()));
+    std::move(m_tailArgs.begin(), m_tailArgs.end(), frame);
+    m_tailArgs.clear();
+    if (m_profiler != nullptr) {
+      m_profiler->exit();
+      m_profiler->enter(function);
     }
-  } catch (std::runtime_error e) {
-    return;
+    m_nativeStack.maybeGrow([&] { result = function->call(this, frame); });
+  }
+  if (m_profiler != nullptr) m_profiler->exit();
+  m_depth--;
+  m_stack.release(mark);
+  return result;
+}
+
+void Interpreter::tailCall(Call& expr) {
+  const Value callee = evaluate(expr.callee);
+  if (failed()) return;
+
+  const int argc = expr.arguments.size();
+  const FrameStack::Mark mark = m_stack.mark();
+  Value* args = m_stack.allocate(argc);
+  for (int i = 0; i < argc; i++) {
+    args[i] = evaluate(expr.arguments[i]);
+    if (failed()) return m_stack.release(mark);
+  }
+
+  PyCallable* function = callee.isFunction() ? callee.asFunction() : nullptr;
+  if (function == nullptr) {
+    // Builtins run at once; their result is what the caller returns.
+    if (callee.isBuiltin()) {
+      Value result =
+          callBuiltin(*callee.asBuiltin(), args, argc, expr.paren.line);
+      m_stack.release(mark);
+      if (failed()) return;
+      m_returnValue = std::move(result);
+      m_completion = Completion::RETURN;
+      return;
+    }
+    m_stack.release(mark);
+    return runtimeError(expr.paren.line, "Can only call functions.");
+  }
+  if (argc != function->arity()) {
+    m_stack.release(mark);
+    return runtimeError(expr.paren.line,
+                        "Expected " + std::to_string(function->arity()) +
+                            " arguments but got " + std::to_string(argc) +
+                            ".");
   }
-  for(Stmt* stmt: statements) {
-    delete stmt;
+
+  // Staged only once the arguments are evaluated, since evaluating them may
+  // run tail calls of its own.
+  m_tailArgs.assign(std::make_move_iterator(args),
+                    std::make_move_iterator(args + argc));
+  m_stack.release(mark);
+  m_tailCallee = function;
+  m_completion = Completion::TAIL_CALL;
+}
+
+void Interpreter::visit(List& expr) {
+  ListObj* list = new ListObj();
+  Value result = Value::list(list);
+  list->reserve(expr.elements.size());
+  for (Expr* element : expr.elements) {
+    Value value = evaluate(element);
+    if (failed()) return Return(Value());
+    list->append(value);
   }
+  Return(result);
 }
 
-void Interpreter::visit(Block& stmt) {
-  executeBlock(stmt.statements, PyInterpreter::Environment(m_environment));
+void Interpreter::visit(Index& expr) {
+  Value object = evaluate(expr.object);
+  if (failed()) return Return(Value());
+  Value index = evaluate(expr.index);
+  if (failed()) return Return(Value());
+
+  Value result;
+  const char* error;
+  if (!Operators::index(object, index, result, error)) {
+    return runtimeError(expr.bracket.line, error);
+  }
+  Return(result);
 }
 
+void Interpreter::visit(SetIndex& expr) {
+  Value value = evaluate(expr.value);
+  if (failed()) return Return(Value());
+  Value object = evaluate(expr.object);
+  if (failed()) return Return(Value());
+  Value index = evaluate(expr.index);
+  if (failed()) return Return(Value());
+
+  const char* error;
+  if (!Operators::setIndex(object, index, value, error)) {
+    return runtimeError(expr.bracket.line, error);
+  }
+  Return(value);
+}
+
+void Interpreter::visit(MethodCall& expr) {
+  Value object = evaluate(expr.object);
+  if (failed()) return Return(Value());
+  Value argument = evaluate(expr.arguments[0]);
+  if (failed()) return Return(Value());
+
+  const char* error;
+  if (!Operators::append(object, argument, error)) {
+    return runtimeError(expr.name.line, error);
+  }
+  Return(Value());
+}
+
+void Interpreter::interpret(const std::vector<Stmt*>& statements) {
+  for (Stmt* stmt : statements) {
+    if (!interpret(stmt)) break;
+  }
+}
+
+bool Interpreter::interpret(Stmt* stmt) {
+  if (execute(stmt) == Completion::NORMAL) return true;
+  if (failed()) {
+    m_out.write(m_errorMessage);
+    m_out.endLine();
+  }
+  m_completion = Completion::NORMAL;
+  return false;
+}
+
+bool Interpreter::run(const std::vector<Stmt*>& statements,
+                      std::string& error) {
+  for (Stmt* stmt : statements) {
+    if (execute(stmt) == Completion::NORMAL) continue;
+    const bool ok = !failed();
+    if (!ok) error = m_errorMessage;
+    m_completion = Completion::NORMAL;
+    return ok;
+  }
+  return true;
+}
+
+bool Interpreter::call(PyCallable* function, const std::vector<Value>& args,
+                       Value& result, std::string& error) {
+  const int argc = args.size();
+  if (argc != function->arity()) {
+    error = "Expected " + std::to_string(function->arity()) +
+            " arguments but got " + std::to_string(argc) + ".";
+    return false;
+  }
+  const FrameStack::Mark mark = m_stack.mark();
+  Value* frame = m_stack.allocate(std::max(argc, function->frameSize()));
+  std::copy(args.begin(), args.end(), frame);
+  result = invoke(function, frame, mark, 0);
+  if (!failed()) return true;
+  error = m_errorMessage;
+  m_completion = Completion::NORMAL;
+  return false;
+}
+
+bool Interpreter::global(std::string_view name, Value& value) const {
+  return global(SymbolTable::instance().intern(name), value);
+}
+
+void Interpreter::printMemoStats(std::ostream& out) const {
+  for (const PyFunction* function : m_memoized) {
+    out << "memo " << function->name() << ": "
+        << function->memoHits() << " hits, " << function->memoMisses()
+        << " misses" << std::endl;
+  }
+}
+
+void Interpreter::visit(Block& stmt) { executeStatements(stmt.statements); }
+
 void Interpreter::visit(IfElseBlock& stmt) {
-  executeIfElseBlock(stmt.statements);
+  executeStatements(stmt.statements);
 }
 
 void Interpreter::visit(Expression& stmt) { evaluate(stmt.expression); }
 
 void Interpreter::visit(Function& stmt) {
   PyFunction* function = new PyFunction(stmt);
-  m_environment.assignFunction(stmt.name, function);
+  m_functions.emplace_back(function);
+  if (function->memoized()) m_memoized.push_back(function);
+  PyCallable* callable = function;
+  // Native self-calls would skip the memo table, turning a memoized
+  // recursion back into an exponential one.
+  if (m_jit != nullptr && !function->memoized()) {
+    if (PyCallable* compiled = m_jit->compile(*function, stmt)) {
+      callable = compiled;
+    }
+  }
+  if (stmt.slot >= 0) {
+    m_frame[stmt.slot] = Value::function(callable);
+  } else {
+    m_globals.assign(stmt.name.symbol, Value::function(callable));
+  }
 }
 
 void Interpreter::visit(If& stmt) {
-  if (isTruthy(evaluate(stmt.condition))) {
+  Value condition = evaluate(stmt.condition);
+  if (failed()) return;
+
+  if (isTruthy(condition)) {
     execute(stmt.thenBranch);
   } else if (stmt.elseBranch != nullptr) {
     execute(stmt.elseBranch);
@@ -149,72 +546,101 @@ void Interpreter::visit(If& stmt) {
 }
 
 void Interpreter::visit(ReturnStmt& stmt) {
-  std::string value = "";
-  if (stmt.value != nullptr) value = evaluate(stmt.value);
+  if (stmt.tailCall) return tailCall(static_cast<Call&>(*stmt.value));
+
+  Value value;
+  if (stmt.value != nullptr) {
+    value = evaluate(stmt.value);
+    if (failed()) return;
+  }
 
-  throw new ReturnObj(value);
+  m_returnValue = std::move(value);
+  m_completion = Completion::RETURN;
 }
 
 void Interpreter::visit(Print& stmt) {
   for (Expr* expr : stmt.expressions) {
-    std::cout << evaluate(expr) << " ";
+    Value value = evaluate(expr);
+    if (failed()) return;
+    m_out.write(value);
+    m_out.write(' ');
   }
-  std::cout << std::endl;
+  m_out.endLine();
 }
 
 void Interpreter::visit(Var& stmt) {
-  std::string val = "";
+  Value val;
   if (stmt.initializer != nullptr) {
     val = evaluate(stmt.initializer);
+    if (failed()) return;
+  }
+  if (stmt.slot >= 0) {
+    m_frame[stmt.slot] = val;
+  } else {
+    m_globals.assign(stmt.name.symbol, val);
   }
-  m_environment.assign(stmt.name, val);
 }
 
-void Interpreter::executeBlock(std::vector<Stmt*> stmts,
-                               const Environment& env) {
-  Environment prev = m_environment;
-  m_environment = env;
-  try {
-    for (Stmt* stmt : stmts) {
-      execute(stmt);
-    }
-  } catch(ReturnObj* e) {
-    m_environment = prev;
-    throw e;
+void Interpreter::visit(While& stmt) {
+  for (;;) {
+    Value condition = evaluate(stmt.condition);
+    if (failed() || !isTruthy(condition)) return;
+    if (executeStatements(stmt.body) != Completion::NORMAL) return;
   }
-  m_environment = prev;
 }
 
-void Interpreter::executeIfElseBlock(std::vector<Stmt*> stmts) {
-  for (Stmt* stmt : stmts) {
-    execute(stmt);
+void Interpreter::visit(For& stmt) {
+  // The counter lives in a plain int64_t; the loop variable only receives
+  // a copy, so assigning to it in the body does not change the iteration.
+  int64_t bounds[3] = {0, 0, 1};
+  Expr* const arguments[3] = {stmt.start, stmt.stop, stmt.step};
+  for (int i = 0; i < 3; i++) {
+    if (arguments[i] == nullptr) continue;
+    Value bound = evaluate(arguments[i]);
+    if (failed()) return;
+    if (!bound.isInt()) {
+      return runtimeError(stmt.range.line,
+                          "range() arguments must be 64-bit integers.");
+    }
+    bounds[i] = bound.asInt();
+  }
+  const int64_t stop = bounds[1];
+  const int64_t step = bounds[2];
+  if (step == 0) {
+    return runtimeError(stmt.range.line, "range() step must not be zero.");
   }
-}
 
-void Interpreter::checkNumberOperand(Token op, std::string operand) {
-  if (isNumber(operand)) return;
-  throw std::runtime_error("Line " + std::to_string(op.line) +
-                           ": Operand must be a number!");
+  for (int64_t i = bounds[0]; step > 0 ? i < stop : i > stop;) {
+    if (stmt.slot >= 0) {
+      m_frame[stmt.slot] = Value::integer(i);
+    } else {
+      m_globals.assign(stmt.name.symbol, Value::integer(i));
+    }
+    if (executeStatements(stmt.body) != Completion::NORMAL) return;
+    // Stepping past the int64_t range also steps past stop.
+    if (__builtin_add_overflow(i, step, &i)) return;
+  }
 }
 
-void Interpreter::checkNumberOperands(Token op, std::string left,
-                                      std::string right) {
-  if (isNumber(left) && isNumber(right)) return;
-  throw std::runtime_error("Line " + std::to_string(op.line) +
-                           ": Operands must be numbers!");
+Completion Interpreter::executeBlock(const std::vector<Stmt*>& stmts,
+                                     Value* frame) {
+  Value* prev = m_frame;
+  m_frame = frame;
+  Completion completion = executeStatements(stmts);
+  m_frame = prev;
+  return completion;
 }
 
-void Interpreter::checkNumberOrStringOperands(Token op, std::string left,
-                                              std::string right) {
-  if (isNumber(left) && isNumber(right)) return;
-  if (!isNumber(left) && !isNumber(right)) return;
-  throw std::runtime_error("Line " + std::to_string(op.line) +
-                           ": Operands must have matching types!");
+Completion Interpreter::executeStatements(const std::vector<Stmt*>& stmts) {
+  for (Stmt* stmt : stmts) {
+    Completion completion = execute(stmt);
+    if (completion != Completion::NORMAL) return completion;
+  }
+  return Completion::NORMAL;
 }
 
-bool Interpreter::isNumber(std::string str) const {
-  for (const auto& c : str) {
-    if (!isdigit(c) && c != '-') return false;
-  }
-  return true;
-}
\ No newline at end of file
+void Interpreter::runtimeError(int line, const std::string& message) {
+  m_completion = Completion::ERROR;
+  m_errorMessage = "Line " + std::to_string(line) + ": " + message;
+  Return(Value());
+}
@@ -1,24 +1,54 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 #include <iostream>
+#include <vector>
 
+#include "Builtins.hpp"
 #include "Environment.hpp"
+#include "FrameStack.hpp"
+#include "NativeStack.hpp"
+#include "OutputSink.hpp"
+#include "Profiler.hpp"
 #include "PyCallable.hpp"
 #include "PyFunction.hpp"
 #include "Scanner.hpp"
 #include "Expr.hpp"
 #include "Stmt.hpp"
 #include "VisitorReturnVal.hpp"
-#include "ReturnObj.hpp"
+#include "Operators.hpp"
+#include "Value.hpp"
 
 namespace PyInterpreter {
+// How a statement finished. RETURN and ERROR unwind through the enclosing
+// statement lists as ordinary return values rather than C++ exceptions.
+// TAIL_CALL is a RETURN whose value is a call still to be made; the callee
+// and arguments are staged on the Interpreter for the caller to run.
+enum class Completion { NORMAL, RETURN, ERROR, TAIL_CALL };
+
+// Calls that may be active at once before "Maximum recursion depth
+// exceeded." is raised, unless overridden with --max-depth.
+const int kDefaultMaxDepth = 500000;
+
 class Environment;
-class Interpreter : public VisitorReturnVal<Interpreter, Expr*, std::string>,
+class Jit;
+class PyFunction;
+class Interpreter : public VisitorReturnVal<Interpreter, Expr*, Value>,
                     public Expr::Visitor,
                     public Stmt::Visitor {
  public:
+  // Prints, and the error that stops a script, go to out. All state of a
+  // run lives in the instance, so interpreters on separate threads are
+  // independent; each must be created on the thread that runs it, for the
+  // sake of its NativeStack.
+  Interpreter(OutputSink& out, int maxDepth = kDefaultMaxDepth)
+      : m_out(out), m_maxDepth(maxDepth) {
+    defineBuiltins();
+  }
+
   void visit(Assign& expr);
   void visit(Literal& expr);
   void visit(Logical& expr);
@@ -27,6 +57,10 @@ class Interpreter : public VisitorReturnVal<Interpreter, Expr*, std::string>,
   void visit(Grouping& expr);
   void visit(Binary& expr);
   void visit(Call& expr);
+  void visit(List& expr);
+  void visit(Index& expr);
+  void visit(SetIndex& expr);
+  void visit(MethodCall& expr);
 
   void visit(Block& stmt);
   void visit(IfElseBlock& stmt);
@@ -36,29 +70,121 @@ class Interpreter : public VisitorReturnVal<Interpreter, Expr*, std::string>,
   void visit(ReturnStmt& stmt);
   void visit(Print& stmt);
   void visit(Var& stmt);
+  void visit(While& stmt);
+  void visit(For& stmt);
 
-  void interpret(std::vector<Stmt*> statements);
-
-  void execute(Stmt* stmt) { stmt->accept(*this); }
-  void executeBlock(std::vector<Stmt*> stmts, const Environment& env);
+  void interpret(const std::vector<Stmt*>& statements);
+  // Runs one top-level statement. Returns false once the script has
+  // stopped, after an error or a top-level return.
+  bool interpret(Stmt* stmt);
+  // Entry points for a host program (Script). Errors are handed back in
+  // error rather than printed. run() executes a script's top level and
+  // call() invokes one of its functions, running any tail calls it makes.
+  bool run(const std::vector<Stmt*>& statements, std::string& error);
+  bool call(PyCallable* function, const std::vector<Value>& args,
+            Value& result, std::string& error);
+  // Returns false if the script has not bound name.
+  bool global(std::string_view name, Value& value) const;
+  bool global(Symbol name, Value& value) const {
+    return m_globals.get(name, value);
+  }
+  // Where name's value is stored, or null if it is unbound. The pointer
+  // stays valid, tracking later assignments, until globalsVersion() changes.
+  const Value* globalSlot(Symbol name) { return m_globals.lookup(name); }
+  uint32_t globalsVersion() const { return m_globals.version(); }
+  // Calls that may still nest before the depth limit is reached.
+  int remainingDepth() const { return m_maxDepth - m_depth; }
+  // Lowest address the current native stack may grow down to.
+  uintptr_t stackLimit() const { return m_nativeStack.limit(); }
+  // Hit and miss counts of every memoized function defined so far.
+  void printMemoStats(std::ostream& out) const;
+  // Reports every call made from now on to profiler, which must outlive
+  // the run.
+  void setProfiler(Profiler* profiler) { m_profiler = profiler; }
+  // Compiles every def that jit supports as it is executed; jit must
+  // outlive the run.
+  void setJit(Jit* jit) { m_jit = jit; }
+  // Drops the global cache entries from first on, whose read sites have
+  // been freed, before the Resolver hands the indices out again.
+  void releaseGlobalCache(int first) {
+    if (static_cast<size_t>(first) < m_globalCache.size()) {
+      m_globalCache.resize(first);
+    }
+  }
 
-  Environment getGlobals() {
-    return m_environment;
+  Completion execute(Stmt* stmt) {
+    if (m_profiler != nullptr) m_profiler->poll();
+    stmt->accept(*this);
+    return m_completion;
+  }
+  // Runs a function body against frame. On RETURN the result is left for
+  // takeReturnValue(); on ERROR the completion stays set for the caller.
+  Completion executeBlock(const std::vector<Stmt*>& stmts, Value* frame);
+  Value takeReturnValue() {
+    m_completion = Completion::NORMAL;
+    return std::move(m_returnValue);
   }
 
  private:
-  std::string evaluate(Expr* expr) { return GetValue(expr); }
-  void executeIfElseBlock(std::vector<Stmt*> stmts);
-  void checkNumberOperand(Token op, std::string operand);
-  void checkNumberOperands(Token op, std::string left, std::string right);
-  void checkNumberOrStringOperands(Token op, std::string left,
-                                   std::string right);
-  bool isTruthy(std::string val) const {
-    return !(val == "") && !(val == "0") && !(val == "null") &&
-           !(val == "false");
+  Value evaluate(Expr* expr) { return GetValue(expr); }
+  Completion executeStatements(const std::vector<Stmt*>& stmts);
+  bool isTruthy(const Value& val) const { return val.truthy(); }
+  void tailCall(Call& expr);
+  void defineBuiltins();
+  // Runs builtin on args, reporting a wrong argument count or a failure at
+  // line.
+  Value callBuiltin(const Builtin& builtin, const Value* args, int argc,
+                    int line);
+  // Value of the global that expr reads, through its cache entry. Raises an
+  // error and returns null if the name is unbound.
+  const Value* readGlobal(Variable& expr) {
+    if (static_cast<size_t>(expr.cache) < m_globalCache.size()) {
+      const GlobalCache& entry = m_globalCache[expr.cache];
+      if (entry.value != nullptr && entry.version == m_globals.version()) {
+        return entry.value;
+      }
+    }
+    return lookupGlobal(expr);
   }
-  bool isNumber(std::string str) const;
+  const Value* lookupGlobal(Variable& expr);
+  // Runs function on frame, allocated at mark, and every tail call it
+  // makes, then releases the frame. A depth error is reported at line.
+  Value invoke(PyCallable* function, Value* frame,
+               const FrameStack::Mark& mark, int line);
+
+  // Expressions report failure by setting ERROR and returning none; callers
+  // test failed() after each subexpression before doing more work.
+  bool failed() const { return m_completion == Completion::ERROR; }
+  void runtimeError(int line, const std::string& message);
+
+  Completion m_completion = Completion::NORMAL;
+  Value m_returnValue;
+  std::string m_errorMessage;
+
+  OutputSink& m_out;
+  Environment m_globals;
+  // Where each global read site last found its value, indexed by
+  // Variable::cache. Entries are per interpreter, so a parsed program can
+  // be shared by threads, but everything one interpreter runs must come from
+  // the same Resolver. An entry is stale once the globals are rehashed;
+  // rebinding a name updates the slot an entry points at.
+  struct GlobalCache {
+    const Value* value = nullptr;
+    uint32_t version = 0;
+  };
+  std::vector<GlobalCache> m_globalCache;
+  FrameStack m_stack;
+  // Slots of the executing function call; null at the top level.
+  Value* m_frame = nullptr;
+  std::vector<std::unique_ptr<PyFunction>> m_functions;
+  std::vector<PyFunction*> m_memoized;
 
-  static Environment m_environment;
+  NativeStack m_nativeStack;
+  int m_depth = 0;
+  const int m_maxDepth;
+  PyCallable* m_tailCallee = nullptr;
+  std::vector<Value> m_tailArgs;
+  Profiler* m_profiler = nullptr;
+  Jit* m_jit = nullptr;
 };
 }  // namespace PyInterpreter
\ No newline at end of file
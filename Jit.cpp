@@ -0,0 +1,660 @@
+#include "Jit.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "Interpreter.hpp"
+
+using namespace PyInterpreter;
+
+namespace {
+// Runs a compiled body on args. Returns false, leaving result unset, if the
+// call had to be abandoned. Recursion stops after depthBudget nested calls
+// or once the stack pointer would pass stackLimit.
+typedef bool (*Entry)(const int64_t* args, int64_t* result,
+                      int64_t depthBudget, uintptr_t stackLimit);
+}  // namespace
+
+struct Jit::Code {
+  void* memory = nullptr;
+  size_t size = 0;
+  Entry entry = nullptr;
+
+  ~Code();
+};
+
+#if defined(__x86_64__)
+namespace {
+enum Reg : uint8_t {
+  RAX = 0,
+  RCX = 1,
+  RDX = 2,
+  RSP = 4,
+  RBP = 5,
+  RSI = 6,
+  RDI = 7,
+  R12 = 12,
+  R13 = 13,
+  R14 = 14,
+  R15 = 15
+};
+
+// x86 condition codes, as used by jcc and setcc.
+enum Condition : uint8_t {
+  OVERFLOW = 0x0,
+  BELOW = 0x2,
+  EQUAL = 0x4,
+  NOT_EQUAL = 0x5,
+  LESS = 0xC,
+  GREATER_EQUAL = 0xD,
+  LESS_EQUAL = 0xE,
+  GREATER = 0xF
+};
+
+// Two-operand ALU opcodes of the "op r/m64, r64" form.
+enum AluOp : uint8_t {
+  ADD = 0x01,
+  SUB = 0x29,
+  XOR = 0x31,
+  CMP = 0x39,
+  TEST = 0x85,
+  MOV = 0x89
+};
+
+// Just enough of an x86-64 encoder for the templates below. Jumps and calls
+// take labels, whose rel32 displacements are filled in by finish().
+class Assembler {
+ public:
+  typedef int Label;
+
+  Label newLabel() {
+    m_labels.push_back(-1);
+    return m_labels.size() - 1;
+  }
+  void bind(Label label) { m_labels[label] = m_code.size(); }
+
+  void push(Reg reg) {
+    if (reg & 8) byte(0x41);
+    byte(0x50 + (reg & 7));
+  }
+  void pop(Reg reg) {
+    if (reg & 8) byte(0x41);
+    byte(0x58 + (reg & 7));
+  }
+  // push qword [base + disp]
+  void pushMemory(Reg base, int32_t disp) {
+    if (base & 8) byte(0x41);
+    byte(0xFF);
+    memoryOperand(6, base, disp);
+  }
+  void load(Reg dst, Reg base, int32_t disp) {
+    rex(dst, base);
+    byte(0x8B);
+    memoryOperand(dst, base, disp);
+  }
+  void store(Reg base, int32_t disp, Reg src) {
+    rex(src, base);
+    byte(0x89);
+    memoryOperand(src, base, disp);
+  }
+  void moveImmediate(Reg dst, int64_t value) {
+    rex(0, dst);
+    if (value >= INT32_MIN && value <= INT32_MAX) {
+      byte(0xC7);
+      modrm(3, 0, dst);
+      int32(value);
+    } else {
+      byte(0xB8 + (dst & 7));
+      for (int i = 0; i < 8; i++) byte(static_cast<uint64_t>(value) >> i * 8);
+    }
+  }
+  // op dst, src
+  void alu(AluOp op, Reg dst, Reg src) {
+    rex(src, dst);
+    byte(op);
+    modrm(3, src, dst);
+  }
+  void addImmediate(Reg dst, int8_t value) { group1(0, dst, value); }
+  void subImmediate(Reg dst, int8_t value) { group1(5, dst, value); }
+  void compareImmediate(Reg dst, int8_t value) { group1(7, dst, value); }
+  void multiply(Reg dst, Reg src) {
+    rex(dst, src);
+    byte(0x0F);
+    byte(0xAF);
+    modrm(3, dst, src);
+  }
+  void negate(Reg reg) { group3(3, reg); }
+  // rax = rdx:rax / divisor, after signExtend().
+  void divide(Reg divisor) { group3(7, divisor); }
+  void signExtend() {
+    byte(0x48);
+    byte(0x99);
+  }
+  // rax = condition ? 1 : 0
+  void set(Condition condition) {
+    byte(0x0F);
+    byte(0x90 | condition);
+    byte(0xC0);
+    byte(0x0F);
+    byte(0xB6);
+    byte(0xC0);
+  }
+  void jump(Label label) {
+    byte(0xE9);
+    reference(label);
+  }
+  void jumpIf(Condition condition, Label label) {
+    byte(0x0F);
+    byte(0x80 | condition);
+    reference(label);
+  }
+  void call(Label label) {
+    byte(0xE8);
+    reference(label);
+  }
+  void ret() { byte(0xC3); }
+
+  // Resolves every label reference and returns the code.
+  std::vector<uint8_t>& finish() {
+    for (const Fixup& fixup : m_fixups) {
+      const int32_t rel = m_labels[fixup.label] - (fixup.offset + 4);
+      std::memcpy(&m_code[fixup.offset], &rel, sizeof(rel));
+    }
+    m_fixups.clear();
+    return m_code;
+  }
+
+ private:
+  struct Fixup {
+    size_t offset;
+    Label label;
+  };
+
+  void byte(uint8_t value) { m_code.push_back(value); }
+  void int32(int32_t value) {
+    for (int i = 0; i < 4; i++) byte(static_cast<uint32_t>(value) >> i * 8);
+  }
+  // REX.W prefix, extended by the high bits of the reg and rm fields.
+  void rex(int reg, int rm) {
+    byte(0x48 | (reg & 8) >> 1 | (rm & 8) >> 3);
+  }
+  void modrm(int mod, int reg, int rm) {
+    byte(mod << 6 | (reg & 7) << 3 | (rm & 7));
+  }
+  // [base + disp32]; rsp and r12 as a base need a SIB byte.
+  void memoryOperand(int reg, Reg base, int32_t disp) {
+    modrm(2, reg, base);
+    if ((base & 7) == RSP) byte(0x24);
+    int32(disp);
+  }
+  void group1(int op, Reg dst, int8_t value) {
+    rex(0, dst);
+    byte(0x83);
+    modrm(3, op, dst);
+    byte(value);
+  }
+  void group3(int op, Reg reg) {
+    rex(0, reg);
+    byte(0xF7);
+    modrm(3, op, reg);
+  }
+  void reference(Label label) {
+    m_fixups.push_back({m_code.size(), label});
+    int32(0);
+  }
+
+  std::vector<uint8_t> m_code;
+  std::vector<size_t> m_labels;
+  std::vector<Fixup> m_fixups;
+};
+
+// Translates one function body, node by node. Every expression leaves its
+// result in rax, ints as themselves and booleans as 0 or 1, and may use rcx
+// and rdx and push temporaries. Parameters live above the saved rbp, pushed
+// by the caller in order. r13 holds the stack pointer to restore on
+// bailout, r14 the remaining depth budget and r15 the stack limit.
+class CodeGenerator : public Expr::Visitor, public Stmt::Visitor {
+ public:
+  explicit CodeGenerator(const Function& function)
+      : m_function(function), m_arity(function.parameters.size()) {}
+
+  // Returns false if the body is outside the supported subset.
+  bool translate(std::vector<uint8_t>& code);
+
+  void visit(Assign&) { m_supported = false; }
+  void visit(Literal& expr);
+  void visit(Logical& expr);
+  void visit(Unary& expr);
+  void visit(Variable& expr);
+  void visit(Grouping& expr) { generate(expr.expression); }
+  void visit(Binary& expr);
+  void visit(Call& expr);
+  void visit(List&) { m_supported = false; }
+  void visit(Index&) { m_supported = false; }
+  void visit(SetIndex&) { m_supported = false; }
+  void visit(MethodCall&) { m_supported = false; }
+
+  void visit(Block& stmt) { generate(stmt.statements); }
+  void visit(IfElseBlock& stmt) { generate(stmt.statements); }
+  void visit(Expression&) { m_supported = false; }
+  void visit(Function&) { m_supported = false; }
+  void visit(If& stmt);
+  void visit(ReturnStmt& stmt);
+  void visit(Print&) { m_supported = false; }
+  void visit(Var&) { m_supported = false; }
+  void visit(While&) { m_supported = false; }
+  void visit(For&) { m_supported = false; }
+
+ private:
+  enum class Kind { INT, BOOL };
+
+  void generate(const std::vector<Stmt*>& stmts) {
+    for (Stmt* stmt : stmts) stmt->accept(*this);
+  }
+  Kind generate(Expr* expr) {
+    m_kind = Kind::INT;
+    expr->accept(*this);
+    return m_kind;
+  }
+  void require(bool supported) {
+    if (!supported) m_supported = false;
+  }
+  // Loads a literal or parameter straight into reg. Returns false for any
+  // other expression.
+  bool loadOperand(Expr* expr, Reg reg, Kind& kind);
+  int32_t parameterOffset(int slot) const {
+    return 16 + 8 * (m_arity - 1 - slot);
+  }
+  bool isSelfCall(Expr* expr) const;
+  void pushArguments(Call& call);
+
+  const Function& m_function;
+  const int m_arity;
+  Assembler m_asm;
+  Assembler::Label m_bailout = 0;
+  Assembler::Label m_call = 0;
+  Assembler::Label m_body = 0;
+  bool m_supported = true;
+  Kind m_kind = Kind::INT;
+};
+
+bool CodeGenerator::translate(std::vector<uint8_t>& code) {
+  m_bailout = m_asm.newLabel();
+  m_call = m_asm.newLabel();
+  m_body = m_asm.newLabel();
+  const Assembler::Label done = m_asm.newLabel();
+
+  // Entry: save the callee-saved registers used, push the arguments and
+  // call the body.
+  const Reg saved[] = {RBP, R12, R13, R14, R15};
+  const int savedCount = sizeof(saved) / sizeof(saved[0]);
+  for (Reg reg : saved) m_asm.push(reg);
+  m_asm.alu(MOV, R12, RSI);
+  m_asm.alu(MOV, R14, RDX);
+  m_asm.alu(MOV, R15, RCX);
+  m_asm.alu(MOV, R13, RSP);
+  for (int i = 0; i < m_arity; i++) m_asm.pushMemory(RDI, 8 * i);
+  m_asm.call(m_call);
+  m_asm.store(R12, 0, RAX);
+  m_asm.moveImmediate(RAX, 1);
+  m_asm.jump(done);
+  // Bailout: every native frame is dropped at once below.
+  m_asm.bind(m_bailout);
+  m_asm.alu(XOR, RAX, RAX);
+  m_asm.bind(done);
+  m_asm.alu(MOV, RSP, R13);
+  for (int i = savedCount - 1; i >= 0; i--) m_asm.pop(saved[i]);
+  m_asm.ret();
+
+  m_asm.bind(m_call);
+  m_asm.push(RBP);
+  m_asm.alu(MOV, RBP, RSP);
+  m_asm.alu(CMP, RSP, R15);
+  m_asm.jumpIf(BELOW, m_bailout);
+  m_asm.subImmediate(R14, 1);
+  m_asm.jumpIf(EQUAL, m_bailout);
+  m_asm.bind(m_body);
+  generate(m_function.body);
+  // Falling off the end returns none, which only the interpreter has.
+  m_asm.jump(m_bailout);
+
+  if (!m_supported) return false;
+  code = std::move(m_asm.finish());
+  return true;
+}
+
+void CodeGenerator::visit(Literal& expr) {
+  if (expr.value.isInt()) {
+    m_asm.moveImmediate(RAX, expr.value.asInt());
+  } else if (expr.value.isBool()) {
+    m_asm.moveImmediate(RAX, expr.value.asBool());
+    m_kind = Kind::BOOL;
+  } else {
+    m_supported = false;
+  }
+}
+
+void CodeGenerator::visit(Variable& expr) {
+  require(expr.slot >= 0 && expr.slot < m_arity);
+  m_asm.load(RAX, RBP, parameterOffset(expr.slot));
+}
+
+void CodeGenerator::visit(Logical& expr) {
+  const Kind left = generate(expr.left);
+  const Assembler::Label end = m_asm.newLabel();
+  m_asm.alu(TEST, RAX, RAX);
+  m_asm.jumpIf(expr.op.type == Token::TokenType::OR ? NOT_EQUAL : EQUAL, end);
+  const Kind right = generate(expr.right);
+  m_asm.bind(end);
+  require(left == right);
+  m_kind = left;
+}
+
+void CodeGenerator::visit(Unary& expr) {
+  const Kind right = generate(expr.right);
+  if (expr.op.type == Token::TokenType::BANG) {
+    m_asm.alu(TEST, RAX, RAX);
+    m_asm.set(EQUAL);
+    m_kind = Kind::BOOL;
+    return;
+  }
+  require(right == Kind::INT);
+  m_asm.negate(RAX);
+  m_asm.jumpIf(OVERFLOW, m_bailout);
+}
+
+void CodeGenerator::visit(Binary& expr) {
+  const Kind left = generate(expr.left);
+  Kind right;
+  if (!loadOperand(expr.right, RCX, right)) {
+    m_asm.push(RAX);
+    right = generate(expr.right);
+    m_asm.alu(MOV, RCX, RAX);
+    m_asm.pop(RAX);
+  }
+
+  m_kind = Kind::BOOL;
+  switch (expr.op.type) {
+    case Token::TokenType::EQUAL_EQUAL:
+    case Token::TokenType::BANG_EQUAL:
+      require(left == right);
+      m_asm.alu(CMP, RAX, RCX);
+      m_asm.set(expr.op.type == Token::TokenType::EQUAL_EQUAL ? EQUAL
+                                                              : NOT_EQUAL);
+      return;
+    case Token::TokenType::GREATER:
+    case Token::TokenType::GREATER_EQUAL:
+    case Token::TokenType::LESS:
+    case Token::TokenType::LESS_EQUAL: {
+      require(left == Kind::INT && right == Kind::INT);
+      m_asm.alu(CMP, RAX, RCX);
+      const Token::TokenType op = expr.op.type;
+      m_asm.set(op == Token::TokenType::GREATER         ? GREATER
+                : op == Token::TokenType::GREATER_EQUAL ? GREATER_EQUAL
+                : op == Token::TokenType::LESS          ? LESS
+                                                        : LESS_EQUAL);
+      return;
+    }
+    default:
+      break;
+  }
+
+  // Arithmetic. A result that needs a BigInt bails out.
+  require(left == Kind::INT && right == Kind::INT);
+  m_kind = Kind::INT;
+  switch (expr.op.type) {
+    case Token::TokenType::PLUS:
+      m_asm.alu(ADD, RAX, RCX);
+      break;
+    case Token::TokenType::MINUS:
+      m_asm.alu(SUB, RAX, RCX);
+      break;
+    case Token::TokenType::STAR:
+      m_asm.multiply(RAX, RCX);
+      break;
+    case Token::TokenType::SLASH: {
+      // Division by zero is the interpreter's error to raise, and
+      // INT64_MIN / -1 its BigInt to make.
+      const Assembler::Label divide = m_asm.newLabel();
+      m_asm.alu(TEST, RCX, RCX);
+      m_asm.jumpIf(EQUAL, m_bailout);
+      m_asm.compareImmediate(RCX, -1);
+      m_asm.jumpIf(NOT_EQUAL, divide);
+      m_asm.moveImmediate(RDX, INT64_MIN);
+      m_asm.alu(CMP, RAX, RDX);
+      m_asm.jumpIf(EQUAL, m_bailout);
+      m_asm.bind(divide);
+      m_asm.signExtend();
+      m_asm.divide(RCX);
+      return;
+    }
+    default:
+      m_supported = false;
+      return;
+  }
+  m_asm.jumpIf(OVERFLOW, m_bailout);
+}
+
+void CodeGenerator::visit(Call& expr) {
+  require(isSelfCall(&expr));
+  if (!m_supported) return;
+  pushArguments(expr);
+  m_asm.call(m_call);
+  if (m_arity > 0) m_asm.addImmediate(RSP, 8 * m_arity);
+  m_kind = Kind::INT;
+}
+
+void CodeGenerator::visit(If& stmt) {
+  generate(stmt.condition);
+  const Assembler::Label otherwise = m_asm.newLabel();
+  const Assembler::Label end = m_asm.newLabel();
+  m_asm.alu(TEST, RAX, RAX);
+  m_asm.jumpIf(EQUAL, otherwise);
+  stmt.thenBranch->accept(*this);
+  m_asm.jump(end);
+  m_asm.bind(otherwise);
+  if (stmt.elseBranch != nullptr) stmt.elseBranch->accept(*this);
+  m_asm.bind(end);
+}
+
+void CodeGenerator::visit(ReturnStmt& stmt) {
+  if (stmt.value == nullptr) {
+    m_supported = false;
+    return;
+  }
+  // A tail call to itself becomes a jump back to the top of the body, with
+  // the new arguments in place of the old.
+  if (stmt.tailCall && isSelfCall(stmt.value)) {
+    pushArguments(static_cast<Call&>(*stmt.value));
+    for (int slot = m_arity - 1; slot >= 0; slot--) {
+      m_asm.pop(RAX);
+      m_asm.store(RBP, parameterOffset(slot), RAX);
+    }
+    m_asm.jump(m_body);
+    return;
+  }
+  require(generate(stmt.value) == Kind::INT);
+  m_asm.addImmediate(R14, 1);
+  m_asm.alu(MOV, RSP, RBP);
+  m_asm.pop(RBP);
+  m_asm.ret();
+}
+
+bool CodeGenerator::loadOperand(Expr* expr, Reg reg, Kind& kind) {
+  kind = Kind::INT;
+  if (Literal* literal = dynamic_cast<Literal*>(expr)) {
+    if (!literal->value.isInt()) return false;
+    m_asm.moveImmediate(reg, literal->value.asInt());
+    return true;
+  }
+  Variable* variable = dynamic_cast<Variable*>(expr);
+  if (variable == nullptr || variable->slot < 0 ||
+      variable->slot >= m_arity) {
+    return false;
+  }
+  m_asm.load(reg, RBP, parameterOffset(variable->slot));
+  return true;
+}
+
+bool CodeGenerator::isSelfCall(Expr* expr) const {
+  Call* call = dynamic_cast<Call*>(expr);
+  if (call == nullptr ||
+      static_cast<int>(call->arguments.size()) != m_arity) {
+    return false;
+  }
+  Variable* callee = dynamic_cast<Variable*>(call->callee);
+  return callee != nullptr && callee->slot < 0 &&
+         callee->name.symbol == m_function.name.symbol;
+}
+
+void CodeGenerator::pushArguments(Call& call) {
+  for (Expr* arg : call.arguments) {
+    require(generate(arg) == Kind::INT);
+    m_asm.push(RAX);
+  }
+}
+
+// The compiled body behind the PyCallable interface. Calls it cannot run
+// natively go to the PyFunction it was compiled from.
+class NativeFunction : public PyCallable {
+ public:
+  NativeFunction(PyFunction& fallback, Symbol name, Entry entry)
+      : m_fallback(fallback), m_name(name), m_entry(entry) {}
+
+  Value call(Interpreter* interpreter, Value* frame);
+
+  int arity() { return m_fallback.arity(); }
+  int frameSize() { return m_fallback.frameSize(); }
+  std::string toString() { return m_fallback.toString(); }
+
+  std::string_view name() const { return m_fallback.name(); }
+  int nativeCalls() const { return m_nativeCalls; }
+  int bailouts() const { return m_bailouts; }
+
+  // Larger functions are left to the interpreter.
+  static const int kMaxArgs = 8;
+
+ private:
+  // Bailouts after which calls stop trying the native code: a function
+  // whose results keep overflowing would otherwise pay for every attempt.
+  static const int kMaxBailouts = 64;
+  // Stack left untouched below native frames, for signal handlers.
+  static const uintptr_t kStackMargin = 64 * 1024;
+
+  // Whether m_name is still bound to this function in interpreter's
+  // globals, checked through a cached slot like a global read.
+  bool bound(Interpreter* interpreter);
+
+  PyFunction& m_fallback;
+  const Symbol m_name;
+  const Entry m_entry;
+  // Calls from the interpreter that finished in native code, and those that
+  // were abandoned; self calls inside the native code are not counted.
+  int m_nativeCalls = 0;
+  int m_bailouts = 0;
+  Interpreter* m_interpreter = nullptr;
+  const Value* m_binding = nullptr;
+  uint32_t m_version = 0;
+};
+
+bool NativeFunction::bound(Interpreter* interpreter) {
+  if (m_binding == nullptr || interpreter != m_interpreter ||
+      m_version != interpreter->globalsVersion()) {
+    m_interpreter = interpreter;
+    m_binding = interpreter->globalSlot(m_name);
+    m_version = interpreter->globalsVersion();
+    if (m_binding == nullptr) return false;
+  }
+  return m_binding->isFunction() && m_binding->asFunction() == this;
+}
+
+Value NativeFunction::call(Interpreter* interpreter, Value* frame) {
+  // The body's calls to itself are direct, so its name must still be bound
+  // to this function.
+  bool native = m_bailouts < kMaxBailouts && bound(interpreter);
+
+  int64_t args[kMaxArgs];
+  const int argc = arity();
+  for (int i = 0; native && i < argc; i++) {
+    native = frame[i].isInt();
+    if (native) args[i] = frame[i].asInt();
+  }
+
+  if (native) {
+    int64_t result;
+    if (m_entry(args, &result, interpreter->remainingDepth() + 1,
+                interpreter->stackLimit() + kStackMargin)) {
+      m_nativeCalls++;
+      return Value::integer(result);
+    }
+    m_bailouts++;
+  }
+  return m_fallback.call(interpreter, frame);
+}
+}  // namespace
+
+Jit::Code::~Code() {
+  if (memory != nullptr) munmap(memory, size);
+}
+
+Jit::Jit() {}
+
+Jit::~Jit() {}
+
+PyCallable* Jit::compile(PyFunction& function, const Function& stmt) {
+  if (stmt.parameters.size() > NativeFunction::kMaxArgs) return nullptr;
+
+  auto found = m_code.find(&stmt);
+  if (found == m_code.end()) {
+    std::unique_ptr<Code> code;
+    std::vector<uint8_t> bytes;
+    if (CodeGenerator(stmt).translate(bytes)) {
+      const size_t page = sysconf(_SC_PAGESIZE);
+      const size_t size = (bytes.size() + page - 1) / page * page;
+      void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (memory != MAP_FAILED) {
+        code.reset(new Code());
+        code->memory = memory;
+        code->size = size;
+        std::memcpy(memory, bytes.data(), bytes.size());
+        if (mprotect(memory, size, PROT_READ | PROT_EXEC) == 0) {
+          code->entry = reinterpret_cast<Entry>(memory);
+        } else {
+          code.reset();
+        }
+      }
+    }
+    found = m_code.emplace(&stmt, std::move(code)).first;
+  }
+  if (found->second == nullptr) return nullptr;
+
+  m_functions.emplace_back(
+      new NativeFunction(function, stmt.name.symbol, found->second->entry));
+  return m_functions.back().get();
+}
+
+void Jit::printStats(std::ostream& out) const {
+  for (const auto& callable : m_functions) {
+    const auto* function = static_cast<const NativeFunction*>(callable.get());
+    out << "jit " << function->name() << ": " << function->nativeCalls()
+        << " native calls, " << function->bailouts() << " bailouts"
+        << std::endl;
+  }
+}
+#else
+Jit::Code::~Code() {}
+
+Jit::Jit() {}
+
+Jit::~Jit() {}
+
+PyCallable* Jit::compile(PyFunction&, const Function&) { return nullptr; }
+
+void Jit::printStats(std::ostream&) const {}
+#endif
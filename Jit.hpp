@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "PyCallable.hpp"
+#include "PyFunction.hpp"
+#include "Stmt.hpp"
+
+namespace PyInterpreter {
+// Template JIT for the tree interpreter (--jit). A def whose body uses only
+// if/else, return, its int parameters, literals, + - * /, comparisons, !,
+// and/or and calls to itself is translated into x86-64 code, each node
+// expanding to a fixed instruction sequence, and installed behind PyCallable
+// in place of the PyFunction. Whatever the machine code cannot finish
+// exactly (an overflow into a BigInt, division by zero, a non-int argument,
+// recursion past the native stack or --max-depth) abandons the native call
+// and reruns it on the tree interpreter, which is safe because such bodies
+// have no side effects. Memoized functions are left to the interpreter,
+// and on other architectures nothing is compiled.
+//
+// Code is written into anonymous memory that is made executable only once
+// it is complete, and never writable again.
+class Jit {
+ public:
+  Jit();
+  ~Jit();
+  Jit(const Jit&) = delete;
+  Jit& operator=(const Jit&) = delete;
+
+  // A native version of function, whose declaration is stmt, or null if
+  // the body is outside the supported subset. function remains the
+  // fallback and must outlive the result, which the Jit owns.
+  PyCallable* compile(PyFunction& function, const Function& stmt);
+
+  // Writes how many calls to each compiled function ran natively and how
+  // many bailed out to the interpreter (--jit-stats).
+  void printStats(std::ostream& out) const;
+
+ private:
+  struct Code;
+
+  // Machine code per declaration, compiled the first time its def runs;
+  // null for declarations that cannot be compiled.
+  std::unordered_map<const Function*, std::unique_ptr<Code>> m_code;
+  std::vector<std::unique_ptr<PyCallable>> m_functions;
+};
+}  // namespace PyInterpreter
@@ -0,0 +1,310 @@
+#include "Kernels.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+using namespace PyInterpreter;
+
+namespace {
+typedef bool (*SumKernel)(const int64_t* data, size_t n, int64_t& result);
+typedef int64_t (*ExtremeKernel)(const int64_t* data, size_t n);
+typedef bool (*ElementwiseKernel)(const int64_t* a, size_t aMask,
+                                  const int64_t* b, size_t bMask,
+                                  int64_t* out, size_t n);
+
+struct Table {
+  SumKernel sum;
+  ExtremeKernel min;
+  ExtremeKernel max;
+  ElementwiseKernel add;
+  ElementwiseKernel subtract;
+};
+
+// The portable loops. The vector versions finish the elements from `from`
+// on, which do not fill a whole vector, with these.
+bool sumFrom(const int64_t* data, size_t from, size_t n, int64_t total,
+             int64_t& result) {
+  for (size_t i = from; i < n; i++) {
+    if (__builtin_add_overflow(total, data[i], &total)) return false;
+  }
+  result = total;
+  return true;
+}
+
+template <bool kMax>
+int64_t extremeFrom(const int64_t* data, size_t from, size_t n,
+                    int64_t best) {
+  for (size_t i = from; i < n; i++) {
+    if (kMax ? data[i] > best : data[i] < best) best = data[i];
+  }
+  return best;
+}
+
+template <Kernels::Op kOp>
+bool elementwiseFrom(const int64_t* a, size_t aMask, const int64_t* b,
+                     size_t bMask, int64_t* out, size_t from, size_t n) {
+  for (size_t i = from; i < n; i++) {
+    const int64_t x = a[i & aMask];
+    const int64_t y = b[i & bMask];
+    bool overflow;
+    switch (kOp) {
+      case Kernels::Op::ADD:
+        overflow = __builtin_add_overflow(x, y, &out[i]);
+        break;
+      case Kernels::Op::SUBTRACT:
+        overflow = __builtin_sub_overflow(x, y, &out[i]);
+        break;
+      default:
+        overflow = __builtin_mul_overflow(x, y, &out[i]);
+        break;
+    }
+    if (overflow) return false;
+  }
+  return true;
+}
+
+bool sumScalar(const int64_t* data, size_t n, int64_t& result) {
+  return sumFrom(data, 0, n, 0, result);
+}
+int64_t minScalar(const int64_t* data, size_t n) {
+  return extremeFrom<false>(data, 1, n, data[0]);
+}
+int64_t maxScalar(const int64_t* data, size_t n) {
+  return extremeFrom<true>(data, 1, n, data[0]);
+}
+template <Kernels::Op kOp>
+bool elementwiseScalar(const int64_t* a, size_t aMask, const int64_t* b,
+                       size_t bMask, int64_t* out, size_t n) {
+  return elementwiseFrom<kOp>(a, aMask, b, bMask, out, 0, n);
+}
+
+const Table kScalar = {sumScalar, minScalar, maxScalar,
+                       elementwiseScalar<Kernels::Op::ADD>,
+                       elementwiseScalar<Kernels::Op::SUBTRACT>};
+
+#if defined(__x86_64__)
+// Overflow is tracked per lane: the sign bit of the mask is set where x + y
+// (or x - y) wrapped around, that is where the result's sign differs from
+// x's although y's sign says it should not.
+
+// SSE2 is part of x86-64, so these need no runtime check.
+__m128i load128(const int64_t* data) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+__m128i addOverflow128(__m128i x, __m128i y, __m128i sum) {
+  return _mm_andnot_si128(_mm_xor_si128(x, y), _mm_xor_si128(x, sum));
+}
+__m128i subtractOverflow128(__m128i x, __m128i y, __m128i difference) {
+  return _mm_and_si128(_mm_xor_si128(x, y), _mm_xor_si128(x, difference));
+}
+bool anySign128(__m128i mask) {
+  return _mm_movemask_pd(_mm_castsi128_pd(mask)) != 0;
+}
+
+bool sumSse2(const int64_t* data, size_t n, int64_t& result) {
+  __m128i total = _mm_setzero_si128();
+  __m128i overflow = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    const __m128i x = load128(data + i);
+    const __m128i sum = _mm_add_epi64(total, x);
+    overflow = _mm_or_si128(overflow, addOverflow128(total, x, sum));
+    total = sum;
+  }
+  if (anySign128(overflow)) return false;
+  int64_t lanes[2];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), total);
+  int64_t start;
+  if (__builtin_add_overflow(lanes[0], lanes[1], &start)) return false;
+  return sumFrom(data, i, n, start, result);
+}
+
+template <Kernels::Op kOp>
+bool elementwiseSse2(const int64_t* a, size_t aMask, const int64_t* b,
+                     size_t bMask, int64_t* out, size_t n) {
+  __m128i overflow = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    const __m128i x = load128(a + (i & aMask));
+    const __m128i y = load128(b + (i & bMask));
+    __m128i result;
+    if (kOp == Kernels::Op::ADD) {
+      result = _mm_add_epi64(x, y);
+      overflow = _mm_or_si128(overflow, addOverflow128(x, y, result));
+    } else {
+      result = _mm_sub_epi64(x, y);
+      overflow = _mm_or_si128(overflow, subtractOverflow128(x, y, result));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), result);
+  }
+  if (anySign128(overflow)) return false;
+  return elementwiseFrom<kOp>(a, aMask, b, bMask, out, i, n);
+}
+
+// SSE2 has no 64-bit compare (pcmpgtq came with SSE4.2), and emulating one
+// from 32-bit compares made min and max slower than the portable loops.
+const Table kSse2 = {sumSse2, minScalar, maxScalar,
+                     elementwiseSse2<Kernels::Op::ADD>,
+                     elementwiseSse2<Kernels::Op::SUBTRACT>};
+
+// The AVX2 versions are compiled for AVX2 whatever the build flags, and
+// only called once the CPU is known to support it.
+#define PY_AVX2 __attribute__((target("avx2")))
+
+PY_AVX2 __m256i load256(const int64_t* data) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+}
+PY_AVX2 __m256i addOverflow256(__m256i x, __m256i y, __m256i sum) {
+  return _mm256_andnot_si256(_mm256_xor_si256(x, y),
+                             _mm256_xor_si256(x, sum));
+}
+PY_AVX2 __m256i subtractOverflow256(__m256i x, __m256i y,
+                                    __m256i difference) {
+  return _mm256_and_si256(_mm256_xor_si256(x, y),
+                          _mm256_xor_si256(x, difference));
+}
+PY_AVX2 bool anySign256(__m256i mask) {
+  return _mm256_movemask_pd(_mm256_castsi256_pd(mask)) != 0;
+}
+
+PY_AVX2 bool sumAvx2(const int64_t* data, size_t n, int64_t& result) {
+  __m256i total = _mm256_setzero_si256();
+  __m256i overflow = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256i x = load256(data + i);
+    const __m256i sum = _mm256_add_epi64(total, x);
+    overflow = _mm256_or_si256(overflow, addOverflow256(total, x, sum));
+    total = sum;
+  }
+  if (anySign256(overflow)) return false;
+  int64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), total);
+  int64_t start;
+  if (!sumFrom(lanes, 0, 4, 0, start)) return false;
+  return sumFrom(data, i, n, start, result);
+}
+
+// Two running extremes, so consecutive compares do not wait on each other.
+template <bool kMax>
+PY_AVX2 int64_t extremeAvx2(const int64_t* data, size_t n) {
+  if (n < 8) return extremeFrom<kMax>(data, 1, n, data[0]);
+  __m256i best[2] = {load256(data), load256(data + 4)};
+  size_t i = 8;
+  for (; i + 8 <= n; i += 8) {
+    for (int j = 0; j < 2; j++) {
+      const __m256i x = load256(data + i + 4 * j);
+      const __m256i better = kMax ? _mm256_cmpgt_epi64(x, best[j])
+                                  : _mm256_cmpgt_epi64(best[j], x);
+      best[j] = _mm256_blendv_epi8(best[j], x, better);
+    }
+  }
+  int64_t lanes[8];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), best[0]);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes + 4), best[1]);
+  return extremeFrom<kMax>(data, i, n, extremeFrom<kMax>(lanes, 1, 8, lanes[0]));
+}
+
+template <Kernels::Op kOp>
+PY_AVX2 bool elementwiseAvx2(const int64_t* a, size_t aMask,
+                             const int64_t* b, size_t bMask, int64_t* out,
+                             size_t n) {
+  __m256i overflow = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256i x = load256(a + (i & aMask));
+    const __m256i y = load256(b + (i & bMask));
+    __m256i result;
+    if (kOp == Kernels::Op::ADD) {
+      result = _mm256_add_epi64(x, y);
+      overflow = _mm256_or_si256(overflow, addOverflow256(x, y, result));
+    } else {
+      result = _mm256_sub_epi64(x, y);
+      overflow =
+          _mm256_or_si256(overflow, subtractOverflow256(x, y, result));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), result);
+  }
+  if (anySign256(overflow)) return false;
+  return elementwiseFrom<kOp>(a, aMask, b, bMask, out, i, n);
+}
+
+#undef PY_AVX2
+
+const Table kAvx2 = {sumAvx2, extremeAvx2<false>, extremeAvx2<true>,
+                     elementwiseAvx2<Kernels::Op::ADD>,
+                     elementwiseAvx2<Kernels::Op::SUBTRACT>};
+#endif
+
+Kernels::Level supported() {
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") ? Kernels::Level::AVX2
+                                        : Kernels::Level::SSE2;
+#else
+  return Kernels::Level::SCALAR;
+#endif
+}
+
+Kernels::Level& active() {
+  static Kernels::Level level = supported();
+  return level;
+}
+
+const Table& table() {
+  switch (active()) {
+#if defined(__x86_64__)
+    case Kernels::Level::AVX2:
+      return kAvx2;
+    case Kernels::Level::SSE2:
+      return kSse2;
+#endif
+    default:
+      return kScalar;
+  }
+}
+}  // namespace
+
+Kernels::Level Kernels::level() { return active(); }
+
+const char* Kernels::name(Level level) {
+  switch (level) {
+    case Level::AVX2:
+      return "avx2";
+    case Level::SSE2:
+      return "sse2";
+    default:
+      return "scalar";
+  }
+}
+
+void Kernels::limit(Level level) {
+  if (level < active()) active() = level;
+}
+
+bool Kernels::sum(const int64_t* data, size_t n, int64_t& result) {
+  return table().sum(data, n, result);
+}
+
+int64_t Kernels::min(const int64_t* data, size_t n) {
+  return table().min(data, n);
+}
+
+int64_t Kernels::max(const int64_t* data, size_t n) {
+  return table().max(data, n);
+}
+
+bool Kernels::elementwise(Op op, const Operand& a, const Operand& b,
+                          int64_t* out, size_t n) {
+  switch (op) {
+    case Op::ADD:
+      return table().add(a.data(), a.mask(), b.data(), b.mask(), out, n);
+    case Op::SUBTRACT:
+      return table().subtract(a.data(), a.mask(), b.data(), b.mask(), out,
+                              n);
+    default:
+      return elementwiseScalar<Op::MULTIPLY>(a.data(), a.mask(), b.data(),
+                                             b.mask(), out, n);
+  }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace PyInterpreter {
+// Loops over int64_t arrays behind the list builtins. Each kernel comes in
+// an AVX2 version and a portable one, and all but min and max in an SSE2
+// version too, picked at runtime: AVX2 where __builtin_cpu_supports reports
+// it, SSE2 on any other x86-64, and the portable loops elsewhere. Kernels
+// never produce a wrapped result; when one cannot be represented they
+// return false and the caller redoes the work with BigInts.
+namespace Kernels {
+enum class Level { SCALAR, SSE2, AVX2 };
+
+// The instruction set the kernels use.
+Level level();
+const char* name(Level level);
+// Uses nothing above level from now on, for comparing the versions. Not
+// thread safe: call it before any script runs.
+void limit(Level level);
+
+// Sets result to the total of data[0, n). Returns false if the total, or
+// a partial sum along the way, does not fit in int64_t.
+bool sum(const int64_t* data, size_t n, int64_t& result);
+// Smallest and largest of data[0, n), where n > 0.
+int64_t min(const int64_t* data, size_t n);
+int64_t max(const int64_t* data, size_t n);
+
+// One side of an element-wise kernel: n values, or a single value that
+// pairs with every element of the other side.
+class Operand {
+ public:
+  static Operand array(const int64_t* data) { return Operand(data); }
+  static Operand scalar(int64_t value) { return Operand(value); }
+
+  // Kernels read element i at data()[i & mask()], so a scalar is read from
+  // copies wide enough for one vector load.
+  const int64_t* data() const { return m_mask != 0 ? m_data : m_copies; }
+  size_t mask() const { return m_mask; }
+
+ private:
+  explicit Operand(const int64_t* data) : m_data(data), m_mask(~size_t(0)) {}
+  explicit Operand(int64_t value)
+      : m_copies{value, value, value, value}, m_data(nullptr), m_mask(0) {}
+
+  int64_t m_copies[4] = {};
+  const int64_t* m_data;
+  size_t m_mask;
+};
+
+enum class Op { ADD, SUBTRACT, MULTIPLY };
+// Sets out[i] to a[i] op b[i] for every i < n. Returns false if any result
+// does not fit in int64_t, leaving out partly written. There is no 64-bit
+// vector multiply below AVX-512, so MULTIPLY is always the portable loop.
+bool elementwise(Op op, const Operand& a, const Operand& b, int64_t* out,
+                 size_t n);
+}  // namespace Kernels
+}  // namespace PyInterpreter
@@ -0,0 +1,77 @@
+#include "NativeStack.hpp"
+
+#include <pthread.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+using namespace PyInterpreter;
+
+namespace {
+// makecontext() can only pass int arguments, so the callback for the
+// segment being entered is handed over through here.
+struct PendingEntry {
+  void (*entry)(void*);
+  void* arg;
+};
+thread_local PendingEntry t_pending;
+
+void trampoline() {
+  PendingEntry pending = t_pending;
+  pending.entry(pending.arg);
+}
+}  // namespace
+
+NativeStack::NativeStack() {
+  char probe;
+  // Without the thread's real bounds, assume a conservative 256 KiB.
+  m_limit = reinterpret_cast<uintptr_t>(&probe) - 256 * 1024;
+
+  pthread_attr_t attr;
+  if (pthread_getattr_np(pthread_self(), &attr) != 0) return;
+  void* base;
+  size_t size;
+  if (pthread_attr_getstack(&attr, &base, &size) == 0) {
+    m_limit = reinterpret_cast<uintptr_t>(base);
+  }
+  pthread_attr_destroy(&attr);
+}
+
+NativeStack::~NativeStack() {
+  for (char* segment : m_segments) munmap(segment, kSegmentSize);
+}
+
+void NativeStack::grow(void (*entry)(void*), void* arg) {
+  char* segment;
+  if (!m_idle.empty()) {
+    segment = m_idle.back();
+    m_idle.pop_back();
+  } else {
+    void* memory =
+        mmap(nullptr, kSegmentSize, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (memory == MAP_FAILED) {
+      // Nowhere to grow; carry on and let the stack overflow.
+      entry(arg);
+      return;
+    }
+    segment = static_cast<char*>(memory);
+    mprotect(segment, kGuardSize, PROT_NONE);
+    m_segments.push_back(segment);
+  }
+
+  const uintptr_t limit = m_limit;
+  m_limit = reinterpret_cast<uintptr_t>(segment) + kGuardSize;
+
+  ucontext_t caller;
+  ucontext_t callee;
+  getcontext(&callee);
+  callee.uc_stack.ss_sp = segment;
+  callee.uc_stack.ss_size = kSegmentSize;
+  callee.uc_link = &caller;
+  makecontext(&callee, trampoline, 0);
+  t_pending = {entry, arg};
+  swapcontext(&caller, &callee);
+
+  m_limit = limit;
+  m_idle.push_back(segment);
+}
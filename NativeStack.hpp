@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace PyInterpreter {
+// Lets deep recursion in the tree walker continue past the end of the
+// thread's own stack. When fewer than kRedZone bytes remain, maybeGrow()
+// runs its callback on a heap-allocated segment instead, in the manner of
+// stacker's maybe_grow. Segments are kept for reuse until the NativeStack is
+// destroyed. Callbacks must not let C++ exceptions escape: they cannot
+// unwind across a segment switch.
+class NativeStack {
+ public:
+  // Records the stack bounds of the calling thread, which must be the
+  // thread that later calls maybeGrow().
+  NativeStack();
+  NativeStack(const NativeStack&) = delete;
+  NativeStack& operator=(const NativeStack&) = delete;
+  ~NativeStack();
+
+  // Lowest usable address of the stack in use right now.
+  uintptr_t limit() const { return m_limit; }
+
+  template <typename F>
+  void maybeGrow(F&& fn) {
+    char probe;
+    if (reinterpret_cast<uintptr_t>(&probe) - m_limit >= kRedZone) {
+      fn();
+      return;
+    }
+    grow(&invoke<typename std::remove_reference<F>::type>, &fn);
+  }
+
+ private:
+  static const size_t kRedZone = 128 * 1024;
+  static const size_t kSegmentSize = 16 * 1024 * 1024;
+  static const size_t kGuardSize = 4096;
+
+  template <typename F>
+  static void invoke(void* fn) {
+    (*static_cast<F*>(fn))();
+  }
+  void grow(void (*entry)(void*), void* arg);
+
+  // Lowest usable address of the stack currently in use.
+  uintptr_t m_limit;
+  std::vector<char*> m_segments;
+  std::vector<char*> m_idle;
+};
+}  // namespace PyInterpreter
@@ -0,0 +1,190 @@
+#include "Operators.hpp"
+
+using namespace PyInterpreter;
+
+namespace {
+const char* const kNumberOperand = "Operand must be a number!";
+const char* const kNumberOperands = "Operands must be numbers!";
+const char* const kMatchingOperands = "Operands must have matching types!";
+const char* const kDivisionByZero = "Division by zero!";
+const char* const kUnknownOperator = "Unknown operator.";
+const char* const kSubscriptable = "Only lists and strings can be indexed!";
+const char* const kListTarget = "Only list elements can be assigned!";
+const char* const kAppendTarget = "Only lists have append()!";
+const char* const kIntegerIndex = "Index must be an integer!";
+const char* const kIndexRange = "Index out of range!";
+
+bool numberOrStringOperands(const Value& left, const Value& right) {
+  return (left.isNumber() && right.isNumber()) ||
+         (left.isString() && right.isString());
+}
+
+// Arithmetic once an operand is a BIGINT or the int64_t result overflowed.
+Value bigArithmetic(Token::TokenType op, const Value& left,
+                    const Value& right) {
+  const BigInt a = left.toBigInt();
+  const BigInt b = right.toBigInt();
+  switch (op) {
+    case Token::TokenType::PLUS:
+      return Value::bigint(a + b);
+    case Token::TokenType::MINUS:
+      return Value::bigint(a - b);
+    case Token::TokenType::STAR:
+      return Value::bigint(a * b);
+    default:
+      return Value::bigint(a / b);
+  }
+}
+
+// The element index refers to in a sequence of size elements.
+bool position(const Value& index, size_t size, size_t& result,
+              const char*& error) {
+  if (!index.isInt()) {
+    error = index.isBigInt() ? kIndexRange : kIntegerIndex;
+    return false;
+  }
+  int64_t i = index.asInt();
+  if (i < 0) i += static_cast<int64_t>(size);
+  if (i < 0 || static_cast<uint64_t>(i) >= size) {
+    error = kIndexRange;
+    return false;
+  }
+  result = i;
+  return true;
+}
+}  // namespace
+
+bool Operators::unary(Token::TokenType op, const Value& right, Value& result,
+                      const char*& error) {
+  if (op == Token::TokenType::BANG) {
+    result = Value::boolean(!right.truthy());
+    return true;
+  }
+  if (!right.isNumber()) {
+    error = kNumberOperand;
+    return false;
+  }
+  if (right.isInt() && right.asInt() != INT64_MIN) {
+    result = Value::integer(-right.asInt());
+  } else {
+    result = Value::bigint(-right.toBigInt());
+  }
+  return true;
+}
+
+bool Operators::binary(Token::TokenType op, const Value& left,
+                       const Value& right, Value& result, const char*& error) {
+  switch (op) {
+    case Token::TokenType::GREATER:
+    case Token::TokenType::GREATER_EQUAL:
+    case Token::TokenType::LESS:
+    case Token::TokenType::LESS_EQUAL: {
+      if (!numberOrStringOperands(left, right)) {
+        error = kMatchingOperands;
+        return false;
+      }
+      int order;
+      if (left.isInt() && right.isInt()) {
+        order = left.asInt() < right.asInt() ? -1
+                : left.asInt() > right.asInt() ? 1
+                                               : 0;
+      } else if (left.isNumber()) {
+        order = left.toBigInt().compare(right.toBigInt());
+      } else {
+        order = left.asString().compare(right.asString());
+      }
+      bool holds = op == Token::TokenType::GREATER         ? order > 0
+                   : op == Token::TokenType::GREATER_EQUAL ? order >= 0
+                   : op == Token::TokenType::LESS          ? order < 0
+                                                           : order <= 0;
+      result = Value::boolean(holds);
+      return true;
+    }
+    case Token::TokenType::BANG_EQUAL:
+      result = Value::boolean(left != right);
+      return true;
+    case Token::TokenType::EQUAL_EQUAL:
+      result = Value::boolean(left == right);
+      return true;
+    case Token::TokenType::PLUS:
+    case Token::TokenType::MINUS:
+    case Token::TokenType::STAR:
+    case Token::TokenType::SLASH: {
+      if (!left.isNumber() || !right.isNumber()) {
+        if (op == Token::TokenType::PLUS && left.isList() &&
+            right.isList()) {
+          ListObj* list = new ListObj();
+          Value concatenation = Value::list(list);
+          const ListObj& a = *left.asList();
+          const ListObj& b = *right.asList();
+          list->reserve(a.size() + b.size());
+          for (size_t i = 0; i < a.size(); i++) list->append(a.get(i));
+          for (size_t i = 0; i < b.size(); i++) list->append(b.get(i));
+          result = std::move(concatenation);
+          return true;
+        }
+        if (op == Token::TokenType::PLUS) {
+          result = Value::string(left.str() + right.str());
+          return true;
+        }
+        error = kNumberOperands;
+        return false;
+      }
+      if (op == Token::TokenType::SLASH && right.isInt() &&
+          right.asInt() == 0) {
+        error = kDivisionByZero;
+        return false;
+      }
+      int64_t value;
+      if (left.isInt() && right.isInt() &&
+          !intOverflow(op, left.asInt(), right.asInt(), value)) {
+        result = Value::integer(value);
+      } else {
+        result = bigArithmetic(op, left, right);
+      }
+      return true;
+    }
+    default:
+      error = kUnknownOperator;
+      return false;
+  }
+}
+
+bool Operators::index(const Value& object, const Value& index, Value& result,
+                      const char*& error) {
+  size_t i;
+  if (object.isList()) {
+    if (!position(index, object.asList()->size(), i, error)) return false;
+    result = object.asList()->get(i);
+    return true;
+  }
+  if (object.isString()) {
+    if (!position(index, object.asString().size(), i, error)) return false;
+    result = Value::string(std::string(1, object.asString()[i]));
+    return true;
+  }
+  error = kSubscriptable;
+  return false;
+}
+
+bool Operators::setIndex(const Value& object, const Value& index,
+                         const Value& value, const char*& error) {
+  if (!object.isList()) {
+    error = kListTarget;
+    return false;
+  }
+  size_t i;
+  if (!position(index, object.asList()->size(), i, error)) return false;
+  object.asList()->set(i, value);
+  return true;
+}
+
+bool Operators::append(const Value& object, const Value& value,
+                       const char*& error) {
+  if (!object.isList()) {
+    error = kAppendTarget;
+    return false;
+  }
+  object.asList()->append(value);
+  return true;
+}
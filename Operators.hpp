@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Token.hpp"
+#include "Value.hpp"
+
+namespace PyInterpreter {
+// Operator semantics shared by the tree interpreter and the bytecode VM.
+// On a type error they return false and point error at a static message;
+// callers attach the line and decide how to unwind.
+namespace Operators {
+bool unary(Token::TokenType op, const Value& right, Value& result,
+           const char*& error);
+bool binary(Token::TokenType op, const Value& left, const Value& right,
+            Value& result, const char*& error);
+// object[index] for lists and strings, and object[index] = value and
+// object.append(value) for lists. Negative indices count from the end, as
+// in Python.
+bool index(const Value& object, const Value& index, Value& result,
+           const char*& error);
+bool setIndex(const Value& object, const Value& index, const Value& value,
+              const char*& error);
+bool append(const Value& object, const Value& value, const char*& error);
+
+// The int64_t fast path of + - * and /. Like the __builtin_*_overflow family
+// it returns true when the exact result does not fit, in which case callers
+// redo the operation on BigInts. Division expects a nonzero divisor.
+inline bool intOverflow(Token::TokenType op, int64_t a, int64_t b,
+                        int64_t& result) {
+  switch (op) {
+    case Token::TokenType::PLUS:
+      return __builtin_add_overflow(a, b, &result);
+    case Token::TokenType::MINUS:
+      return __builtin_sub_overflow(a, b, &result);
+    case Token::TokenType::STAR:
+      return __builtin_mul_overflow(a, b, &result);
+    default:
+      if (a == INT64_MIN && b == -1) return true;
+      result = a / b;
+      return false;
+  }
+}
+}  // namespace Operators
+}  // namespace PyInterpreter
@@ -0,0 +1,399 @@
+#include "Optimizer.hpp"
+
+#include "Operators.hpp"
+
+using namespace PyInterpreter;
+
+namespace {
+// Counts the nodes of a tree, so the pass can report how many it removed.
+class NodeCounter : public Expr::Visitor, public Stmt::Visitor {
+ public:
+  int count(const std::vector<Stmt*>& stmts) {
+    for (Stmt* stmt : stmts) stmt->accept(*this);
+    return m_count;
+  }
+
+  void visit(Assign& expr) { add(expr.value); }
+  void visit(Literal&) { m_count++; }
+  void visit(Logical& expr) { add(expr.left, expr.right); }
+  void visit(Unary& expr) { add(expr.right); }
+  void visit(Variable&) { m_count++; }
+  void visit(Grouping& expr) { add(expr.expression); }
+  void visit(Binary& expr) { add(expr.left, expr.right); }
+  void visit(Call& expr) {
+    add(expr.callee);
+    for (Expr* arg : expr.arguments) arg->accept(*this);
+  }
+  void visit(List& expr) {
+    m_count++;
+    for (Expr* element : expr.elements) element->accept(*this);
+  }
+  void visit(Index& expr) { add(expr.object, expr.index); }
+  void visit(SetIndex& expr) {
+    add(expr.object, expr.index);
+    expr.value->accept(*this);
+  }
+  void visit(MethodCall& expr) {
+    add(expr.object);
+    for (Expr* arg : expr.arguments) arg->accept(*this);
+  }
+
+  void visit(Block& stmt) { addAll(stmt.statements); }
+  void visit(IfElseBlock& stmt) { addAll(stmt.statements); }
+  void visit(Expression& stmt) { add(stmt.expression); }
+  void visit(Function& stmt) { addAll(stmt.body); }
+  void visit(If& stmt) {
+    add(stmt.condition);
+    stmt.thenBranch->accept(*this);
+    if (stmt.elseBranch != nullptr) stmt.elseBranch->accept(*this);
+  }
+  void visit(ReturnStmt& stmt) {
+    m_count++;
+    if (stmt.value != nullptr) stmt.value->accept(*this);
+  }
+  void visit(Print& stmt) {
+    m_count++;
+    for (Expr* expr : stmt.expressions) expr->accept(*this);
+  }
+  void visit(Var& stmt) {
+    m_count++;
+    if (stmt.initializer != nullptr) stmt.initializer->accept(*this);
+  }
+  void visit(While& stmt) {
+    add(stmt.condition);
+    for (Stmt* inner : stmt.body) inner->accept(*this);
+  }
+  void visit(For& stmt) {
+    add(stmt.stop);
+    if (stmt.start != nullptr) stmt.start->accept(*this);
+    if (stmt.step != nullptr) stmt.step->accept(*this);
+    for (Stmt* inner : stmt.body) inner->accept(*this);
+  }
+
+ private:
+  void add(Expr* expr, Expr* other = nullptr) {
+    m_count++;
+    expr->accept(*this);
+    if (other != nullptr) other->accept(*this);
+  }
+  void addAll(const std::vector<Stmt*>& stmts) {
+    m_count++;
+    for (Stmt* stmt : stmts) stmt->accept(*this);
+  }
+
+  int m_count = 0;
+};
+
+// Counts the bindings of each global: top-level assignments, defs and for
+// loops. A binding inside a loop may run any number of times, so it counts
+// as two.
+class BindingCounter : public Expr::Visitor, public Stmt::Visitor {
+ public:
+  BindingCounter(std::unordered_map<Symbol, int>& bindings)
+      : m_bindings(bindings) {}
+
+  void count(const std::vector<Stmt*>& stmts) {
+    for (Stmt* stmt : stmts) stmt->accept(*this);
+  }
+
+  void visit(Assign& expr) {
+    if (expr.slot < 0) bind(expr.name.symbol);
+    expr.value->accept(*this);
+  }
+  void visit(Literal&) {}
+  void visit(Logical& expr) {
+    expr.left->accept(*this);
+    expr.right->accept(*this);
+  }
+  void visit(Unary& expr) { expr.right->accept(*this); }
+  void visit(Variable&) {}
+  void visit(Grouping& expr) { expr.expression->accept(*this); }
+  void visit(Binary& expr) {
+    expr.left->accept(*this);
+    expr.right->accept(*this);
+  }
+  void visit(Call& expr) {
+    expr.callee->accept(*this);
+    for (Expr* arg : expr.arguments) arg->accept(*this);
+  }
+  void visit(List& expr) {
+    for (Expr* element : expr.elements) element->accept(*this);
+  }
+  void visit(Index& expr) {
+    expr.object->accept(*this);
+    expr.index->accept(*this);
+  }
+  void visit(SetIndex& expr) {
+    expr.value->accept(*this);
+    expr.object->accept(*this);
+    expr.index->accept(*this);
+  }
+  void visit(MethodCall& expr) {
+    expr.object->accept(*this);
+    for (Expr* arg : expr.arguments) arg->accept(*this);
+  }
+
+  void visit(Block& stmt) { count(stmt.statements); }
+  void visit(IfElseBlock& stmt) { count(stmt.statements); }
+  void visit(Expression& stmt) { stmt.expression->accept(*this); }
+  void visit(Function& stmt) {
+    if (stmt.slot < 0) bind(stmt.name.symbol);
+    count(stmt.body);
+  }
+  void visit(If& stmt) {
+    stmt.condition->accept(*this);
+    stmt.thenBranch->accept(*this);
+    if (stmt.elseBranch != nullptr) stmt.elseBranch->accept(*this);
+  }
+  void visit(ReturnStmt& stmt) {
+    if (stmt.value != nullptr) stmt.value->accept(*this);
+  }
+  void visit(Print& stmt) {
+    for (Expr* expr : stmt.expressions) expr->accept(*this);
+  }
+  void visit(Var& stmt) {
+    if (stmt.slot < 0) bind(stmt.name.symbol);
+    if (stmt.initializer != nullptr) stmt.initializer->accept(*this);
+  }
+  void visit(While& stmt) {
+    stmt.condition->accept(*this);
+    m_loops++;
+    count(stmt.body);
+    m_loops--;
+  }
+  void visit(For& stmt) {
+    if (stmt.start != nullptr) stmt.start->accept(*this);
+    stmt.stop->accept(*this);
+    if (stmt.step != nullptr) stmt.step->accept(*this);
+    m_loops++;
+    if (stmt.slot < 0) bind(stmt.name.symbol);
+    count(stmt.body);
+    m_loops--;
+  }
+
+ private:
+  void bind(Symbol name) { m_bindings[name] += m_loops > 0 ? 2 : 1; }
+
+  std::unordered_map<Symbol, int>& m_bindings;
+  // Loops enclosing the statement being counted.
+  int m_loops = 0;
+};
+
+const Literal* asLiteral(const Expr* expr) {
+  return dynamic_cast<const Literal*>(expr);
+}
+}  // namespace
+
+void Optimizer::optimize(std::vector<Stmt*>& statements) {
+  const int before = NodeCounter().count(statements);
+
+  m_bindings.clear();
+  m_constants.clear();
+  BindingCounter(m_bindings).count(statements);
+  m_topLevel = true;
+  optimizeStatements(statements);
+
+  m_removedNodes = before - NodeCounter().count(statements);
+}
+
+void Optimizer::optimizeStatements(std::vector<Stmt*>& stmts) {
+  std::vector<Stmt*> output;
+  output.reserve(stmts.size());
+  std::vector<Stmt*>* enclosing = m_output;
+  m_output = &output;
+  for (Stmt* stmt : stmts) stmt->accept(*this);
+  m_output = enclosing;
+  stmts.swap(output);
+}
+
+void Optimizer::visit(Assign& expr) {
+  expr.value = fold(expr.value);
+  Return(&expr);
+}
+
+void Optimizer::visit(Literal& expr) { Return(&expr); }
+
+void Optimizer::visit(Logical& expr) {
+  expr.left = fold(expr.left);
+  expr.right = fold(expr.right);
+
+  const Literal* left = asLiteral(expr.left);
+  if (left == nullptr) return Return(&expr);
+  // The operand a constant left side selects is the result of the whole
+  // expression, so it replaces it even when the right side is not constant.
+  const bool truthy = left->value.truthy();
+  if (expr.op.type == Token::TokenType::OR) {
+    return Return(truthy ? expr.left : expr.right);
+  }
+  Return(truthy ? expr.right : expr.left);
+}
+
+void Optimizer::visit(Unary& expr) {
+  expr.right = fold(expr.right);
+
+  const Literal* right = asLiteral(expr.right);
+  Value result;
+  const char* error;
+  if (right == nullptr ||
+      !Operators::unary(expr.op.type, right->value, result, error)) {
+    return Return(&expr);
+  }
+  Return(m_arena.make<Literal>(result));
+}
+
+void Optimizer::visit(Variable& expr) {
+  if (expr.slot >= 0) return Return(&expr);
+  auto found = m_constants.find(expr.name.symbol);
+  if (found == m_constants.end()) return Return(&expr);
+  Return(m_arena.make<Literal>(found->second));
+}
+
+void Optimizer::visit(Grouping& expr) { Return(fold(expr.expression)); }
+
+void Optimizer::visit(Binary& expr) {
+  expr.left = fold(expr.left);
+  expr.right = fold(expr.right);
+
+  const Literal* left = asLiteral(expr.left);
+  const Literal* right = asLiteral(expr.right);
+  Value result;
+  const char* error;
+  // Operations that would fail are left for the runtime to report.
+  if (left == nullptr || right == nullptr ||
+      !Operators::binary(expr.op.type, left->value, right->value, result,
+                         error)) {
+    return Return(&expr);
+  }
+  Return(m_arena.make<Literal>(result));
+}
+
+void Optimizer::visit(Call& expr) {
+  expr.callee = fold(expr.callee);
+  for (Expr*& arg : expr.arguments) arg = fold(arg);
+  Return(&expr);
+}
+
+// Lists are mutable, so list expressions are never folded; only their
+// operands are.
+void Optimizer::visit(List& expr) {
+  for (Expr*& element : expr.elements) element = fold(element);
+  Return(&expr);
+}
+
+void Optimizer::visit(Index& expr) {
+  expr.object = fold(expr.object);
+  expr.index = fold(expr.index);
+  Return(&expr);
+}
+
+void Optimizer::visit(SetIndex& expr) {
+  expr.value = fold(expr.value);
+  expr.object = fold(expr.object);
+  expr.index = fold(expr.index);
+  Return(&expr);
+}
+
+void Optimizer::visit(MethodCall& expr) {
+  expr.object = fold(expr.object);
+  for (Expr*& arg : expr.arguments) arg = fold(arg);
+  Return(&expr);
+}
+
+void Optimizer::visit(Block& stmt) {
+  optimizeStatements(stmt.statements);
+  m_output->push_back(&stmt);
+}
+
+void Optimizer::visit(IfElseBlock& stmt) {
+  optimizeStatements(stmt.statements);
+  m_output->push_back(&stmt);
+}
+
+void Optimizer::visit(Expression& stmt) {
+  stmt.expression = fold(stmt.expression);
+  m_output->push_back(&stmt);
+}
+
+void Optimizer::visit(Function& stmt) {
+  const bool topLevel = m_topLevel;
+  m_topLevel = false;
+  optimizeStatements(stmt.body);
+  m_topLevel = topLevel;
+  m_output->push_back(&stmt);
+}
+
+void Optimizer::visit(If& stmt) {
+  stmt.condition = fold(stmt.condition);
+
+  const bool topLevel = m_topLevel;
+  m_topLevel = false;
+  const Literal* condition = asLiteral(stmt.condition);
+  if (condition == nullptr) {
+    // The branches rebuild their own statement lists in place.
+    std::vector<Stmt*> branches;
+    std::vector<Stmt*>* enclosing = m_output;
+    m_output = &branches;
+    stmt.thenBranch->accept(*this);
+    if (stmt.elseBranch != nullptr) stmt.elseBranch->accept(*this);
+    m_output = enclosing;
+    m_output->push_back(&stmt);
+  } else {
+    // Branches do not introduce a scope, so the taken one is spliced into
+    // the enclosing statement list.
+    Stmt* taken =
+        condition->value.truthy() ? stmt.thenBranch : stmt.elseBranch;
+    if (IfElseBlock* block = dynamic_cast<IfElseBlock*>(taken)) {
+      for (Stmt* inner : block->statements) inner->accept(*this);
+    } else if (taken != nullptr) {
+      taken->accept(*this);
+    }
+  }
+  m_topLevel = topLevel;
+}
+
+void Optimizer::visit(ReturnStmt& stmt) {
+  if (stmt.value != nullptr) stmt.value = fold(stmt.value);
+  m_output->push_back(&stmt);
+}
+
+void Optimizer::visit(Print& stmt) {
+  for (Expr*& expr : stmt.expressions) expr = fold(expr);
+  m_output->push_back(&stmt);
+}
+
+void Optimizer::visit(Var& stmt) {
+  if (stmt.initializer != nullptr) stmt.initializer = fold(stmt.initializer);
+  m_output->push_back(&stmt);
+
+  // Only an unconditional top-level binding is known to have run before
+  // everything that follows it.
+  if (!m_topLevel || stmt.slot >= 0) return;
+  if (m_bindings[stmt.name.symbol] != 1) return;
+  const Literal* value = asLiteral(stmt.initializer);
+  if (value != nullptr) m_constants.emplace(stmt.name.symbol, value->value);
+}
+
+void Optimizer::visit(While& stmt) {
+  stmt.condition = fold(stmt.condition);
+
+  // A loop that never runs is dropped like an If that is never taken.
+  const Literal* condition = asLiteral(stmt.condition);
+  if (condition != nullptr && !condition->value.truthy()) return;
+  const bool topLevel = m_topLevel;
+  m_topLevel = false;
+  optimizeStatements(stmt.body);
+  m_topLevel = topLevel;
+  m_output->push_back(&stmt);
+}
+
+void Optimizer::visit(For& stmt) {
+  if (stmt.start != nullptr) stmt.start = fold(stmt.start);
+  stmt.stop = fold(stmt.stop);
+  if (stmt.step != nullptr) stmt.step = fold(stmt.step);
+
+  const bool topLevel = m_topLevel;
+  m_topLevel = false;
+  optimizeStatements(stmt.body);
+  m_topLevel = topLevel;
+  m_output->push_back(&stmt);
+}
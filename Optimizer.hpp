@@ -0,0 +1,73 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "Arena.hpp"
+#include "Expr.hpp"
+#include "Stmt.hpp"
+#include "SymbolTable.hpp"
+#include "Value.hpp"
+#include "VisitorReturnVal.hpp"
+
+namespace PyInterpreter {
+// Optional pass between the Resolver and execution (enabled by -O).
+//  - Folds Unary, Binary, Logical and Grouping nodes whose operands are
+//    literals, unless evaluating them would raise an error.
+//  - Propagates globals that are bound exactly once, by a top-level
+//    assignment of a constant, into the code that runs after it: later
+//    top-level statements and functions defined later.
+//  - Replaces an If whose condition folds to a constant with the taken
+//    branch, and drops a while loop whose condition folds to false.
+// Expression visits return the replacement node; statement visits append
+// the replacement statements (possibly none) to the list being rebuilt.
+class Optimizer : public VisitorReturnVal<Optimizer, Expr*, Expr*>,
+                  public Expr::Visitor,
+                  public Stmt::Visitor {
+ public:
+  // New nodes are allocated from arena, the program's node arena.
+  Optimizer(Arena& arena) : m_arena(arena) {}
+
+  void optimize(std::vector<Stmt*>& statements);
+  // AST nodes eliminated by the last optimize() call.
+  int removedNodes() const { return m_removedNodes; }
+
+  void visit(Assign& expr);
+  void visit(Literal& expr);
+  void visit(Logical& expr);
+  void visit(Unary& expr);
+  void visit(Variable& expr);
+  void visit(Grouping& expr);
+  void visit(Binary& expr);
+  void visit(Call& expr);
+  void visit(List& expr);
+  void visit(Index& expr);
+  void visit(SetIndex& expr);
+  void visit(MethodCall& expr);
+
+  void visit(Block& stmt);
+  void visit(IfElseBlock& stmt);
+  void visit(Expression& stmt);
+  void visit(Function& stmt);
+  void visit(If& stmt);
+  void visit(ReturnStmt& stmt);
+  void visit(Print& stmt);
+  void visit(Var& stmt);
+  void visit(While& stmt);
+  void visit(For& stmt);
+
+ private:
+  Expr* fold(Expr* expr) { return GetValue(expr); }
+  void optimizeStatements(std::vector<Stmt*>& stmts);
+
+  Arena& m_arena;
+  // Statements produced for the list currently being rebuilt.
+  std::vector<Stmt*>* m_output = nullptr;
+  // Number of times each global is bound anywhere in the program.
+  std::unordered_map<Symbol, int> m_bindings;
+  // Globals whose single binding has already executed, with their value.
+  std::unordered_map<Symbol, Value> m_constants;
+  bool m_topLevel = false;
+  int m_removedNodes = 0;
+};
+}  // namespace PyInterpreter
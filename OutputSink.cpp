@@ -0,0 +1,108 @@
+#include "OutputSink.hpp"
+
+#include <cerrno>
+#include <charconv>
+#include <iostream>
+
+using namespace PyInterpreter;
+
+OutputSink::OutputSink(int fd, FlushPolicy policy, bool async)
+    : m_fd(fd), m_policy(policy), m_async(async) {
+  if (m_policy == FlushPolicy::AUTO) {
+    m_policy = isatty(fd) ? FlushPolicy::LINE : FlushPolicy::SIZE;
+  }
+  std::cout.flush();
+  m_buffer.reserve(kBufferSize);
+  if (m_async) {
+    m_pending.reserve(kBufferSize);
+    m_writer = std::thread(&OutputSink::writerLoop, this);
+  }
+}
+
+OutputSink::OutputSink(std::string& capture)
+    : m_fd(-1),
+      m_capture(&capture),
+      m_policy(FlushPolicy::EXIT),
+      m_async(false) {}
+
+OutputSink::~OutputSink() {
+  flush();
+  if (m_async) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopping = true;
+    }
+    m_changed.notify_all();
+    m_writer.join();
+  }
+}
+
+void OutputSink::write(const Value& value) {
+  if (value.isInt()) {
+    char digits[24];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value.asInt()).ptr;
+    write(std::string_view(digits, end - digits));
+  } else if (value.isString()) {
+    write(std::string_view(value.asString()));
+  } else {
+    write(std::string_view(value.str()));
+  }
+}
+
+void OutputSink::flush() {
+  submit();
+  if (!m_async) return;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_changed.wait(lock, [this] { return !m_busy; });
+}
+
+void OutputSink::submit() {
+  if (m_buffer.empty()) return;
+  if (!m_async) {
+    writeAll(m_buffer);
+    m_buffer.clear();
+    return;
+  }
+
+  // Swap buffers once the writer has finished the previous one; the
+  // emptied buffer keeps its capacity for reuse.
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_changed.wait(lock, [this] { return !m_busy; });
+  m_pending.swap(m_buffer);
+  m_buffer.clear();
+  m_busy = true;
+  lock.unlock();
+  m_changed.notify_all();
+}
+
+void OutputSink::writeAll(const std::string& data) {
+  if (m_capture != nullptr) {
+    m_capture->append(data);
+    return;
+  }
+  const char* next = data.data();
+  size_t left = data.size();
+  while (left > 0 && !m_failed) {
+    ssize_t written = ::write(m_fd, next, left);
+    if (written < 0) {
+      if (errno != EINTR) m_failed = true;
+      continue;
+    }
+    next += written;
+    left -= written;
+  }
+}
+
+void OutputSink::writerLoop() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_changed.wait(lock, [this] { return m_busy || m_stopping; });
+    if (!m_busy) return;
+    lock.unlock();
+    writeAll(m_pending);
+    lock.lock();
+    m_pending.clear();
+    m_busy = false;
+    m_changed.notify_all();
+  }
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "Value.hpp"
+
+namespace PyInterpreter {
+// Buffered destination for everything a script prints. Output collects in
+// a reusable buffer and reaches the file descriptor with write(2) when the
+// flush policy says so, instead of once per line through std::endl.
+//
+// With an async sink, a full buffer is handed to a writer thread and the
+// interpreter carries on filling a second one, so formatting and the
+// system call overlap. The writer never holds more than one buffer, which
+// bounds memory and keeps output in order.
+class OutputSink {
+ public:
+  enum class FlushPolicy {
+    // LINE on a terminal, SIZE otherwise.
+    AUTO,
+    // After every line, as std::endl did.
+    LINE,
+    // Whenever kBufferSize bytes are waiting.
+    SIZE,
+    // Only at flush() or destruction; the buffer grows as needed.
+    EXIT
+  };
+
+  // Output already written through std::cout is flushed first, so it stays
+  // ahead of anything written here.
+  explicit OutputSink(int fd = STDOUT_FILENO,
+                      FlushPolicy policy = FlushPolicy::AUTO,
+                      bool async = false);
+  // Appends everything to capture instead of writing it anywhere, for
+  // output that is to be printed later.
+  explicit OutputSink(std::string& capture);
+  OutputSink(const OutputSink&) = delete;
+  OutputSink& operator=(const OutputSink&) = delete;
+  ~OutputSink();
+
+  void write(std::string_view text) {
+    m_buffer.append(text);
+    if (m_buffer.size() >= kBufferSize && m_policy == FlushPolicy::SIZE) {
+      submit();
+    }
+  }
+  void write(char c) { m_buffer.push_back(c); }
+  // The same text as value.str(), without the temporary for ints and
+  // strings.
+  void write(const Value& value);
+  void endLine() {
+    m_buffer.push_back('\n');
+    if (m_policy == FlushPolicy::LINE ||
+        (m_buffer.size() >= kBufferSize && m_policy == FlushPolicy::SIZE)) {
+      submit();
+    }
+  }
+
+  // Writes out everything buffered so far and waits for it to complete.
+  // Call before writing diagnostics to another stream.
+  void flush();
+
+  // Lets std::cout be pointed at a sink, so that messages still written
+  // through it stay in order with the buffered output.
+  class StreamBuffer : public std::streambuf {
+   public:
+    explicit StreamBuffer(OutputSink& sink) : m_sink(sink) {}
+
+   protected:
+    int overflow(int c) {
+      if (c != traits_type::eof()) m_sink.write(static_cast<char>(c));
+      return traits_type::not_eof(c);
+    }
+    std::streamsize xsputn(const char* text, std::streamsize count) {
+      m_sink.write(std::string_view(text, count));
+      return count;
+    }
+    int sync() {
+      m_sink.flush();
+      return 0;
+    }
+
+   private:
+    OutputSink& m_sink;
+  };
+
+ private:
+  static const size_t kBufferSize = 64 * 1024;
+
+  void submit();
+  void writeAll(const std::string& data);
+  void writerLoop();
+
+  const int m_fd;
+  std::string* const m_capture = nullptr;
+  FlushPolicy m_policy;
+  std::string m_buffer;
+  // Set once a write fails; later output is dropped.
+  bool m_failed = false;
+
+  // Async state: the writer owns m_pending while m_busy is set.
+  bool m_async;
+  std::string m_pending;
+  bool m_busy = false;
+  bool m_stopping = false;
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::thread m_writer;
+};
+}  // namespace PyInterpreter
@@ -2,6 +2,11 @@
 
 using namespace PyInterpreter;
 
+Parser::Parser(Scanner& scanner, Arena& arena, std::ostream& messages)
+    : m_scanner(&scanner), m_arena(&arena), m_messages(messages) {
+  fill(1);
+}
+
 std::vector<Stmt*> Parser::parse() {
   std::vector<Stmt*> statements;
   clearEmptyLines();
@@ -12,33 +17,60 @@ std::vector<Stmt*> Parser::parse() {
   return statements;
 }
 
+Stmt* Parser::parseStatement() {
+  if (!m_started) {
+    clearEmptyLines();
+    m_started = true;
+  }
+  if (isAtEnd()) return nullptr;
+  Stmt* stmt = declaration();
+  clearEmptyLines();
+
+  // Nothing before previous() can be looked at again.
+  if (m_scanner != nullptr && m_current > 1) {
+    std::vector<Token> window(m_tokens.begin() + m_current - 1,
+                              m_tokens.end());
+    m_tokens.swap(window);
+    m_current = 1;
+  }
+  return stmt;
+}
+
 Stmt* Parser::declaration() {
   indentation();
   try {
-    if (match({Token::TokenType::DEF})) {
+    if (match(Token::TokenType::DEF)) {
       return function("function");
     }
-    if (peek().type == Token::TokenType::IDENTIFIER) {
+    // A name alone on a line, or followed by =, binds it; a name starting
+    // any other expression, such as a call, is an expression statement.
+    if (peek().type == Token::TokenType::IDENTIFIER &&
+        (next().type == Token::TokenType::EQUAL ||
+         next().type == Token::TokenType::INDENTATION ||
+         next().type == Token::TokenType::ENDOFFILE)) {
       return varDeclaration();
     }
     return statement();
-  } catch (std::runtime_error e) {
-    std::cout << e.what() << std::endl;
+  } catch (const std::runtime_error& e) {
+    m_messages << e.what() << std::endl;
+    m_hadError = true;
     synchronize();
     return nullptr;
   }
 }
 
 Stmt* Parser::statement() {
-  if (match({Token::TokenType::IF})) return ifStatement();
-  if (match({Token::TokenType::RETURN})) return returnStatement();
-  if (match({Token::TokenType::PRINT})) return printStatement();
+  if (match(Token::TokenType::IF)) return ifStatement();
+  if (match(Token::TokenType::WHILE)) return whileStatement();
+  if (match(Token::TokenType::FOR)) return forStatement();
+  if (match(Token::TokenType::RETURN)) return returnStatement();
+  if (match(Token::TokenType::PRINT)) return printStatement();
   return expressionStatement();
 }
 
 Stmt* Parser::expressionStatement() {
   Expr* expr = expression();
-  return new Expression(expr);
+  return m_arena->make<Expression>(expr);
 }
 
 Stmt* Parser::function(const std::string& kind) {
@@ -53,7 +85,7 @@ Stmt* Parser::function(const std::string& kind) {
       }
       parameters.push_back(
           consume(Token::TokenType::IDENTIFIER, "Expect parameter name."));
-    } while (match({Token::TokenType::COMMA}));
+    } while (match(Token::TokenType::COMMA));
   }
   consume(Token::TokenType::RIGHT_PAREN, "Expect ')' after parameters.");
 
@@ -61,7 +93,8 @@ Stmt* Parser::function(const std::string& kind) {
   m_indentation = peek().lexeme.size();
 
   std::vector<Stmt*> body = block(m_indentation);
-  return new Function(name, parameters, body);
+  m_functionsParsed++;
+  return m_arena->make<Function>(name, parameters, body);
 }
 
 Stmt* Parser::ifStatement() {
@@ -71,19 +104,56 @@ Stmt* Parser::ifStatement() {
   int localIndentation = m_indentation;
   m_indentation = peek().lexeme.size();
 
-  Stmt* thenBranch = new IfElseBlock(block(m_indentation));
+  Stmt* thenBranch = m_arena->make<IfElseBlock>(block(m_indentation));
   Stmt* elseBranch = nullptr;
   clearEmptyLines();
-  if(next().type == Token::TokenType::ELSE && peek().lexeme.size() == localIndentation) {
+  if(next().type == Token::TokenType::ELSE && peek().lexeme.size() == static_cast<size_t>(localIndentation)) {
     indentation();
     consume(Token::TokenType::ELSE, "Expect else");
     consume(Token::TokenType::COLON, "Expect colon after else");
     clearEmptyLines();
     m_indentation = peek().lexeme.size();
-    elseBranch = new IfElseBlock(block(m_indentation));
+    elseBranch = m_arena->make<IfElseBlock>(block(m_indentation));
   }
 
-  return new If(condition, thenBranch, elseBranch);
+  return m_arena->make<If>(condition, thenBranch, elseBranch);
+}
+
+Stmt* Parser::whileStatement() {
+  Expr* condition = expression();
+  consume(Token::TokenType::COLON, "Expect colon after condition");
+  clearEmptyLines();
+  m_indentation = peek().lexeme.size();
+
+  std::vector<Stmt*> body = block(m_indentation);
+  return m_arena->make<While>(condition, body);
+}
+
+// range is not a keyword, so it stays usable as a name everywhere else.
+Stmt* Parser::forStatement() {
+  Token name = consume(Token::TokenType::IDENTIFIER, "Expect loop variable.");
+  consume(Token::TokenType::IN, "Expect 'in' after loop variable.");
+  Token range = consume(Token::TokenType::IDENTIFIER, "Expect range(...)");
+  if (range.lexeme != "range") throw std::runtime_error("Expect range(...)");
+  consume(Token::TokenType::LEFT_PAREN, "Expect '(' after range");
+
+  std::vector<Expr*> arguments;
+  do {
+    arguments.push_back(expression());
+  } while (match(Token::TokenType::COMMA));
+  if (arguments.size() > 3) {
+    throw std::runtime_error("range takes at most 3 arguments");
+  }
+  consume(Token::TokenType::RIGHT_PAREN, "Expect ')' after range arguments.");
+  consume(Token::TokenType::COLON, "Expect colon after range");
+  clearEmptyLines();
+  m_indentation = peek().lexeme.size();
+
+  std::vector<Stmt*> body = block(m_indentation);
+  Expr* start = arguments.size() > 1 ? arguments[0] : nullptr;
+  Expr* stop = arguments.size() > 1 ? arguments[1] : arguments[0];
+  Expr* step = arguments.size() > 2 ? arguments[2] : nullptr;
+  return m_arena->make<For>(name, range, start, stop, step, body);
 }
 
 Stmt* Parser::returnStatement() {
@@ -93,7 +163,7 @@ Stmt* Parser::returnStatement() {
     value = expression();
   }
 
-  return new ReturnStmt(keyword, value);
+  return m_arena->make<ReturnStmt>(keyword, value);
 }
 
 Stmt* Parser::printStatement() {
@@ -106,17 +176,17 @@ Stmt* Parser::printStatement() {
     expressions.push_back(expression());
   }
   consume(Token::TokenType::RIGHT_PAREN, "Expect ) at end of argument list");
-  return new Print(expressions);
+  return m_arena->make<Print>(expressions);
 }
 
 Stmt* Parser::varDeclaration() {
   Token name = consume(Token::TokenType::IDENTIFIER, "Expect variable name.");
 
   Expr* initializer = nullptr;
-  if (match({Token::TokenType::EQUAL})) {
+  if (match(Token::TokenType::EQUAL)) {
     initializer = expression();
   }
-  return new Var(name, initializer);
+  return m_arena->make<Var>(name, initializer);
 }
 
 std::vector<Stmt*> Parser::block(int indentation) {
@@ -143,175 +213,179 @@ void Parser::clearEmptyLines() {
   if(next().type == Token::TokenType::ENDOFFILE) advance();
 }
 
-Expr* Parser::expression() { return assignment(); }
-
-Expr* Parser::assignment() {
-  Expr* expr = orLogic();
-
-  if (match({Token::TokenType::EQUAL})) {
-    Token equals = previous();
-    Expr* value = assignment();
+Expr* Parser::expression() { return parsePrecedence(Precedence::ASSIGNMENT); }
 
-    if (dynamic_cast<Variable*>(expr)) {
-      Token name = ((Variable*)expr)->name;
-      return new Assign(name, value);
-    }
+// Precedence climbing: a prefix rule parses the operand that starts the
+// expression, then every following operator that binds at least as tightly
+// as precedence extends it through its infix rule.
+Expr* Parser::parsePrecedence(Precedence precedence) {
+  PrefixRule prefix = s_rules[index(peek().type)].prefix;
+  if (prefix == nullptr) throw std::runtime_error("Expect expression.");
+  advance();
+  Expr* expr = (this->*prefix)();
 
-    throw std::runtime_error("Invalid assignment target");
+  while (precedence <= s_rules[index(peek().type)].precedence) {
+    InfixRule infix = s_rules[index(advance().type)].infix;
+    expr = (this->*infix)(expr);
   }
-
   return expr;
 }
 
-Expr* Parser::orLogic() {
-  Expr* expr = andLogic();
-
-  while (match({Token::TokenType::OR})) {
-    Token op = previous();
-    Expr* right = andLogic();
-    expr = new Logical(expr, op, right);
+Expr* Parser::assignment(Expr* target) {
+  // Right associative: a = b = c assigns c to b first.
+  Expr* value = parsePrecedence(Precedence::ASSIGNMENT);
+  if (Variable* variable = dynamic_cast<Variable*>(target)) {
+    return m_arena->make<Assign>(variable->name, value);
   }
-
-  return expr;
-}
-
-Expr* Parser::andLogic() {
-  Expr* expr = equality();
-
-  while (match({Token::TokenType::AND})) {
-    Token op = previous();
-    Expr* right = equality();
-    expr = new Logical(expr, op, right);
+  if (Index* element = dynamic_cast<Index*>(target)) {
+    return m_arena->make<SetIndex>(element->object, element->bracket,
+                                   element->index, value);
   }
-
-  return expr;
+  throw std::runtime_error("Invalid assignment target");
 }
 
-Expr* Parser::equality() {
-  Expr* expr = comparison();
-
-  while (match({Token::TokenType::BANG_EQUAL, Token::TokenType::EQUAL_EQUAL})) {
-    Token op = previous();
-    Expr* right = comparison();
-    expr = new Binary(expr, op, right);
-  }
-
-  return expr;
+Expr* Parser::logical(Expr* left) {
+  Token op = previous();
+  Expr* right = parsePrecedence(higher(s_rules[index(op.type)].precedence));
+  return m_arena->make<Logical>(left, op, right);
 }
 
-Expr* Parser::comparison() {
-  Expr* expr = term();
-
-  while (match({Token::TokenType::GREATER, Token::TokenType::GREATER_EQUAL,
-                Token::TokenType::LESS, Token::TokenType::LESS_EQUAL})) {
-    Token op = previous();
-    Expr* right = term();
-    expr = new Binary(expr, op, right);
-  }
-
-  return expr;
+Expr* Parser::binary(Expr* left) {
+  Token op = previous();
+  Expr* right = parsePrecedence(higher(s_rules[index(op.type)].precedence));
+  return m_arena->make<Binary>(left, op, right);
 }
 
-Expr* Parser::term() {
-  Expr* expr = factor();
-
-  while (match({Token::TokenType::MINUS, Token::TokenType::PLUS})) {
-    Token op = previous();
-    Expr* right = factor();
-    expr = new Binary(expr, op, right);
-  }
-
-  return expr;
+Expr* Parser::unary() {
+  Token op = previous();
+  Expr* right = parsePrecedence(Precedence::UNARY);
+  return m_arena->make<Unary>(op, right);
 }
 
-Expr* Parser::factor() {
-  Expr* expr = unary();
-
-  while (match({Token::TokenType::SLASH, Token::TokenType::STAR})) {
-    Token op = previous();
-    Expr* right = unary();
-    expr = new Binary(expr, op, right);
-  }
-
-  return expr;
+Expr* Parser::grouping() {
+  Expr* expr = expression();
+  consume(Token::TokenType::RIGHT_PAREN, "Expect ')' after expression.");
+  return m_arena->make<Grouping>(expr);
 }
 
-Expr* Parser::unary() {
-  if (match({Token::TokenType::BANG, Token::TokenType::MINUS})) {
-    Token op = previous();
-    Expr* right = unary();
-    return new Unary(op, right);
+Expr* Parser::literal() {
+  switch (previous().type) {
+    case Token::TokenType::FALSE:
+      return m_arena->make<Literal>(Value::boolean(false));
+    case Token::TokenType::TRUE:
+      return m_arena->make<Literal>(Value::boolean(true));
+    default:
+      return m_arena->make<Literal>(Value::none());
   }
-
-  return call();
 }
 
-Expr* Parser::call() {
-  Expr* expr = primary();
-
-  while (true) {
-    if (match({Token::TokenType::LEFT_PAREN})) {
-      expr = finishCall(expr);
-    } else {
-      break;
-    }
+Expr* Parser::number() {
+  std::string_view digits = previous().lexeme;
+  int64_t value = 0;
+  std::from_chars_result result =
+      std::from_chars(digits.data(), digits.data() + digits.size(), value);
+  // Literals too long for an int64_t become BIGINTs.
+  if (result.ec == std::errc::result_out_of_range) {
+    return m_arena->make<Literal>(Value::bigint(BigInt::parse(digits)));
   }
-
-  return expr;
+  return m_arena->make<Literal>(Value::integer(value));
 }
 
-Expr* Parser::primary() {
-  if (match({Token::TokenType::FALSE})) {
-    return new Literal("false");
-  }
-  if (match({Token::TokenType::TRUE})) {
-    return new Literal("true");
-  }
-  if (match({Token::TokenType::NUL})) {
-    return new Literal("null");
-  }
-  if (match({Token::TokenType::NUMBER, Token::TokenType::STRING})) {
-    return new Literal(previous().lexeme);
-  }
-  if (match({Token::TokenType::IDENTIFIER})) {
-    return new Variable(previous());
-  }
-  if (match({Token::TokenType::LEFT_PAREN})) {
-    Expr* expr = expression();
-    consume(Token::TokenType::RIGHT_PAREN, "Expect ')' after expression.");
-    return new Grouping(expr);
-  }
-
-  throw std::runtime_error("Expect expression.");
+Expr* Parser::string() {
+  return m_arena->make<Literal>(Value::string(std::string(previous().lexeme)));
 }
 
+Expr* Parser::variable() { return m_arena->make<Variable>(previous()); }
+
 Expr* Parser::finishCall(Expr* callee) {
   std::vector<Expr*> arguments;
   if (!check(Token::TokenType::RIGHT_PAREN)) {
     do {
       arguments.push_back(expression());
-    } while (match({Token::TokenType::COMMA}));
+    } while (match(Token::TokenType::COMMA));
   }
 
   Token paren =
       consume(Token::TokenType::RIGHT_PAREN, "Expect ')' after arguments.");
 
-  return new Call(callee, paren, arguments);
+  return m_arena->make<Call>(callee, paren, arguments);
 }
 
-bool Parser::match(std::vector<Token::TokenType> types) {
-  for (const auto& type : types) {
-    if (check(type)) {
-      advance();
-      return true;
-    }
+Expr* Parser::list() {
+  Token bracket = previous();
+  std::vector<Expr*> elements;
+  if (!check(Token::TokenType::RIGHT_BRACKET)) {
+    do {
+      elements.push_back(expression());
+    } while (match(Token::TokenType::COMMA));
   }
-  return false;
+  consume(Token::TokenType::RIGHT_BRACKET, "Expect ']' after list elements.");
+  return m_arena->make<List>(bracket, elements);
 }
 
-Token Parser::consume(Token::TokenType type, std::string message) {
+Expr* Parser::subscript(Expr* object) {
+  Token bracket = previous();
+  Expr* index = expression();
+  consume(Token::TokenType::RIGHT_BRACKET, "Expect ']' after index.");
+  return m_arena->make<Index>(object, bracket, index);
+}
+
+Expr* Parser::methodCall(Expr* object) {
+  Token name = consume(Token::TokenType::IDENTIFIER, "Expect method name.");
+  if (name.lexeme != "append") {
+    throw std::runtime_error("Unknown method " + std::string(name.lexeme));
+  }
+  consume(Token::TokenType::LEFT_PAREN, "Expect '(' after method name.");
+  std::vector<Expr*> arguments;
+  arguments.push_back(expression());
+  consume(Token::TokenType::RIGHT_PAREN, "append takes exactly 1 argument");
+  return m_arena->make<MethodCall>(object, name,
+                                   MethodCall::Method::APPEND, arguments);
+}
+
+const std::array<Parser::ParseRule, Parser::kTokenTypes> Parser::s_rules = [] {
+  typedef Token::TokenType T;
+  std::array<ParseRule, kTokenTypes> rules{};
+  auto set = [&rules](T type, PrefixRule prefix, InfixRule infix,
+                      Precedence precedence) {
+    rules[index(type)] = {prefix, infix, precedence};
+  };
+  set(T::LEFT_PAREN, &Parser::grouping, &Parser::finishCall, Precedence::CALL);
+  set(T::LEFT_BRACKET, &Parser::list, &Parser::subscript, Precedence::CALL);
+  set(T::DOT, nullptr, &Parser::methodCall, Precedence::CALL);
+  set(T::EQUAL, nullptr, &Parser::assignment, Precedence::ASSIGNMENT);
+  set(T::OR, nullptr, &Parser::logical, Precedence::OR);
+  set(T::AND, nullptr, &Parser::logical, Precedence::AND);
+  set(T::BANG_EQUAL, nullptr, &Parser::binary, Precedence::EQUALITY);
+  set(T::EQUAL_EQUAL, nullptr, &Parser::binary, Precedence::EQUALITY);
+  set(T::GREATER, nullptr, &Parser::binary, Precedence::COMPARISON);
+  set(T::GREATER_EQUAL, nullptr, &Parser::binary, Precedence::COMPARISON);
+  set(T::LESS, nullptr, &Parser::binary, Precedence::COMPARISON);
+  set(T::LESS_EQUAL, nullptr, &Parser::binary, Precedence::COMPARISON);
+  set(T::MINUS, &Parser::unary, &Parser::binary, Precedence::TERM);
+  set(T::PLUS, nullptr, &Parser::binary, Precedence::TERM);
+  set(T::SLASH, nullptr, &Parser::binary, Precedence::FACTOR);
+  set(T::STAR, nullptr, &Parser::binary, Precedence::FACTOR);
+  set(T::BANG, &Parser::unary, nullptr, Precedence::NONE);
+  set(T::FALSE, &Parser::literal, nullptr, Precedence::NONE);
+  set(T::TRUE, &Parser::literal, nullptr, Precedence::NONE);
+  set(T::NONE, &Parser::literal, nullptr, Precedence::NONE);
+  set(T::NUL, &Parser::literal, nullptr, Precedence::NONE);
+  set(T::NUMBER, &Parser::number, nullptr, Precedence::NONE);
+  set(T::STRING, &Parser::string, nullptr, Precedence::NONE);
+  set(T::IDENTIFIER, &Parser::variable, nullptr, Precedence::NONE);
+  return rules;
+}();
+
+bool Parser::match(Token::TokenType type) {
+  if (!check(type)) return false;
+  advance();
+  return true;
+}
+
+const Token& Parser::consume(Token::TokenType type, std::string_view message) {
   if (check(type)) return advance();
-  throw std::runtime_error(message);
+  throw std::runtime_error(std::string(message));
 }
 
 bool Parser::check(Token::TokenType type) const {
@@ -319,11 +393,22 @@ bool Parser::check(Token::TokenType type) const {
   return peek().type == type;
 }
 
-Token Parser::advance() {
-  if (!isAtEnd()) m_current++;
+const Token& Parser::advance() {
+  if (!isAtEnd()) {
+    m_current++;
+    if (m_scanner != nullptr) fill(m_current + 1);
+  }
   return previous();
 }
 
+void Parser::fill(size_t index) {
+  while (m_tokens.size() <= index &&
+         (m_tokens.empty() ||
+          m_tokens.back().type != Token::TokenType::ENDOFFILE)) {
+    m_tokens.push_back(m_scanner->nextToken());
+  }
+}
+
 void Parser::synchronize() {
   advance();
   while (!isAtEnd()) {
@@ -1,40 +1,98 @@
 #pragma once
 
+#include <array>
+#include <charconv>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 #include <iostream>
 
+#include "./Arena.hpp"
 #include "./Expr.hpp"
+#include "./Scanner.hpp"
 #include "./Stmt.hpp"
 #include "./Token.hpp"
 
 namespace PyInterpreter {
 class Parser {
  public:
-  Parser(const std::vector<Token> tokens) : m_tokens(tokens) {}
+  // Nodes are allocated from arena, which must outlive them. Syntax errors
+  // are reported to messages.
+  Parser(std::vector<Token>&& tokens, Arena& arena,
+         std::ostream& messages = std::cout)
+      : m_tokens(std::move(tokens)), m_arena(&arena), m_messages(messages) {}
+  // Pulls tokens from scanner as parsing needs them, keeping only the few
+  // still in reach of the lookahead.
+  Parser(Scanner& scanner, Arena& arena, std::ostream& messages = std::cout);
   std::vector<Stmt*> parse();
+  // Parses one top-level statement; null at the end of the script, or if
+  // the statement had a syntax error (see hadError()).
+  Stmt* parseStatement();
+  bool hadError() const { return m_hadError; }
+
+  // Nodes made from now on come from arena.
+  void setArena(Arena& arena) { m_arena = &arena; }
+  // Function declarations made so far, so a caller can tell whether a
+  // statement defined any.
+  int functionsParsed() const { return m_functionsParsed; }
 
  private:
+  // Binding strength of infix operators, weakest first.
+  enum class Precedence {
+    NONE,
+    ASSIGNMENT,
+    OR,
+    AND,
+    EQUALITY,
+    COMPARISON,
+    TERM,
+    FACTOR,
+    UNARY,
+    CALL
+  };
+  typedef Expr* (Parser::*PrefixRule)();
+  typedef Expr* (Parser::*InfixRule)(Expr* left);
+  // How a token parses at the start of an expression, and after one.
+  struct ParseRule {
+    PrefixRule prefix;
+    InfixRule infix;
+    Precedence precedence;
+  };
+  static const size_t kTokenTypes =
+      static_cast<size_t>(Token::TokenType::ENDOFFILE) + 1;
+  static const std::array<ParseRule, kTokenTypes> s_rules;
+  static constexpr size_t index(Token::TokenType type) {
+    return static_cast<size_t>(type);
+  }
+  static Precedence higher(Precedence precedence) {
+    return static_cast<Precedence>(static_cast<int>(precedence) + 1);
+  }
+
   Stmt* declaration();
   Expr* expression();
-  Expr* assignment();
-  Expr* orLogic();
-  Expr* andLogic();
-  Expr* equality();
-  Expr* comparison();
-  Expr* term();
-  Expr* factor();
-  Expr* unary();
-  Expr* call();
-  Expr* primary();
+  Expr* parsePrecedence(Precedence precedence);
 
+  Expr* assignment(Expr* target);
+  Expr* logical(Expr* left);
+  Expr* binary(Expr* left);
   Expr* finishCall(Expr* callee);
+  Expr* subscript(Expr* object);
+  Expr* methodCall(Expr* object);
+  Expr* unary();
+  Expr* grouping();
+  Expr* literal();
+  Expr* number();
+  Expr* string();
+  Expr* variable();
+  Expr* list();
 
   Stmt* statement();
   Stmt* expressionStatement();
   Stmt* function(const std::string& kind);
   Stmt* ifStatement();
+  Stmt* whileStatement();
+  Stmt* forStatement();
   Stmt* returnStatement();
   Stmt* printStatement();
   Stmt* varDeclaration();
@@ -43,21 +101,31 @@ class Parser {
   void indentation();
   void clearEmptyLines();
 
-  bool match(std::vector<Token::TokenType> types);
-  Token consume(Token::TokenType type, std::string message);
+  bool match(Token::TokenType type);
+  const Token& consume(Token::TokenType type, std::string_view message);
   bool check(Token::TokenType type) const;
-  Token advance();
+  const Token& advance();
+  void fill(size_t index);
   bool isAtEnd() const { return peek().type == Token::TokenType::ENDOFFILE; }
-  Token peek() const { return m_tokens[m_current]; }
-  Token next() const { 
-    if(!isAtEnd()) return m_tokens[m_current + 1];
-    return Token(Token::TokenType::ENDOFFILE, "", m_current);
+  const Token& peek() const { return m_tokens[m_current]; }
+  const Token& next() const {
+    // The last token is always ENDOFFILE.
+    if (!isAtEnd()) return m_tokens[m_current + 1];
+    return m_tokens.back();
   }
-  Token previous() const { return m_tokens[m_current - 1]; }
+  const Token& previous() const { return m_tokens[m_current - 1]; }
   void synchronize();
 
-  const std::vector<Token> m_tokens;
+  std::vector<Token> m_tokens;
+  // Source of further tokens when streaming; m_tokens then holds a window
+  // that always extends one token past m_current until ENDOFFILE.
+  Scanner* m_scanner = nullptr;
+  Arena* m_arena;
+  std::ostream& m_messages;
   int m_current = 0;
   int m_indentation = 0;
+  bool m_hadError = false;
+  bool m_started = false;
+  int m_functionsParsed = 0;
 };
 }  // namespace PyInterpreter
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "Profiler.hpp"
+
+#include <sys/time.h>
+
+#include <algorithm>
+#include <iomanip>
+
+#include "PyFunction.hpp"
+
+using namespace PyInterpreter;
+
+namespace {
+const char* const kScriptFrame = "<script>";
+}  // namespace
+
+volatile std::sig_atomic_t Profiler::s_ticks = 0;
+
+void Profiler::onSignal(int) { s_ticks = s_ticks + 1; }
+
+void Profiler::start() {
+  s_ticks = 0;
+  m_ticksSampled = 0;
+  struct sigaction action = {};
+  action.sa_handler = &Profiler::onSignal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGPROF, &action, &m_previousAction);
+
+  struct itimerval timer = {};
+  timer.it_interval.tv_sec = m_intervalMicros / 1000000;
+  timer.it_interval.tv_usec = m_intervalMicros % 1000000;
+  timer.it_value = timer.it_interval;
+  setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+void Profiler::stop() {
+  struct itimerval timer = {};
+  setitimer(ITIMER_PROF, &timer, nullptr);
+  sigaction(SIGPROF, &m_previousAction, nullptr);
+}
+
+void Profiler::sample() {
+  // Every tick since the last record was spent somewhere in this stack, as
+  // far as the interpreter can tell: nothing was called or returned from.
+  const std::sig_atomic_t ticks = s_ticks;
+  const uint64_t weight = ticks - m_ticksSampled;
+  m_ticksSampled = ticks;
+  m_samples += weight;
+
+  m_key.assign(kScriptFrame);
+  size_t first = 0;
+  if (m_stack.size() > kMaxFoldedFrames) {
+    first = m_stack.size() - kMaxFoldedFrames;
+    m_key += ";[truncated]";
+  }
+  for (size_t i = first; i < m_stack.size(); i++) {
+    m_key += ';';
+    m_key += label(m_stack[i]).name;
+  }
+  m_folded[m_key] += weight;
+
+  for (PyCallable* callee : m_stack) {
+    Label& frame = label(callee);
+    if (frame.lastSample == m_samples) continue;
+    frame.lastSample = m_samples;
+    frame.total += weight;
+  }
+  if (m_stack.empty()) {
+    m_scriptSelf += weight;
+  } else {
+    label(m_stack.back()).self += weight;
+  }
+}
+
+Profiler::Label& Profiler::label(PyCallable* callee) {
+  auto found = m_labelOf.find(callee);
+  if (found != m_labelOf.end()) return m_labels[found->second];
+
+  // Every function object made by one def shares a label.
+  std::string name;
+  if (PyFunction* function = dynamic_cast<PyFunction*>(callee)) {
+    name = std::string(function->name()) + ":" +
+           std::to_string(function->line());
+  } else {
+    name = callee->toString();
+  }
+  auto named = m_labelNamed.emplace(name, m_labels.size());
+  if (named.second) {
+    m_labels.emplace_back();
+    m_labels.back().name = name;
+  }
+  m_labelOf.emplace(callee, named.first->second);
+  return m_labels[named.first->second];
+}
+
+void Profiler::writeFolded(std::ostream& out) const {
+  std::vector<std::pair<std::string, uint64_t>> stacks(m_folded.begin(),
+                                                       m_folded.end());
+  std::sort(stacks.begin(), stacks.end());
+  for (const auto& stack : stacks) {
+    out << stack.first << " " << stack.second << "\n";
+  }
+}
+
+void Profiler::writeTable(std::ostream& out, size_t topN) const {
+  std::vector<const Label*> ranked;
+  for (const Label& label : m_labels) ranked.push_back(&label);
+  std::sort(ranked.begin(), ranked.end(), [](const Label* a, const Label* b) {
+    return a->self != b->self ? a->self > b->self : a->total > b->total;
+  });
+  if (ranked.size() > topN) ranked.resize(topN);
+
+  const double samples = m_samples == 0 ? 1 : m_samples;
+  out << "profile: " << m_samples << " samples, one per "
+      << m_intervalMicros / 1000.0 << " ms of CPU time" << std::endl;
+  out << "   self%  total%  function" << std::endl;
+  auto row = [&](double self, double total, const std::string& name) {
+    out << std::fixed << std::setprecision(1) << std::setw(7)
+        << self * 100 / samples << "% " << std::setw(6)
+        << total * 100 / samples << "%  " << name << std::endl;
+  };
+  row(m_scriptSelf, m_samples, kScriptFrame);
+  for (const Label* label : ranked) row(label->self, label->total, label->name);
+  out.unsetf(std::ios::floatfield);
+}
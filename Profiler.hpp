@@ -0,0 +1,82 @@
+#pragma once
+
+#include <csignal>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "PyCallable.hpp"
+
+namespace PyInterpreter {
+// Sampling profiler for the tree interpreter (--profile). The Interpreter
+// keeps a shadow stack of the calls in progress through enter() and exit().
+// A SIGPROF interval timer only counts ticks; the stack is recorded at the
+// next statement, call or return, outside the signal handler, where it is
+// safe to allocate, and weighted by the ticks since the previous record.
+// Samples are aggregated as folded stacks for flame graph tools and as
+// per-function self and total counts.
+//
+// Only one Profiler may be running at a time, since SIGPROF is process-wide.
+// The default 10 ms interval matches the CPU time accounting granularity of
+// common kernels; shorter intervals are not delivered any more often.
+class Profiler {
+ public:
+  explicit Profiler(int intervalMicros = 10000)
+      : m_intervalMicros(intervalMicros) {}
+
+  void start();
+  void stop();
+
+  void enter(PyCallable* callee) {
+    poll();
+    m_stack.push_back(callee);
+  }
+  void exit() {
+    poll();
+    m_stack.pop_back();
+  }
+  // Records the ticks since the last sample, if any, against the current
+  // stack. Called at every statement, so loops without calls are sampled.
+  void poll() {
+    if (s_ticks != m_ticksSampled) sample();
+  }
+
+  // One "root;caller;callee count" line per distinct stack.
+  void writeFolded(std::ostream& out) const;
+  // The topN functions by self samples, with their total samples.
+  void writeTable(std::ostream& out, size_t topN) const;
+
+ private:
+  struct Label {
+    std::string name;
+    uint64_t self = 0;
+    uint64_t total = 0;
+    // Last sample that counted towards total, so recursion counts once.
+    uint64_t lastSample = 0;
+  };
+
+  // Stacks deeper than this are folded as their innermost frames only.
+  static const size_t kMaxFoldedFrames = 256;
+
+  static void onSignal(int);
+  void sample();
+  Label& label(PyCallable* callee);
+
+  // Timer ticks since start(), written only by the signal handler.
+  static volatile std::sig_atomic_t s_ticks;
+
+  const int m_intervalMicros;
+  std::vector<PyCallable*> m_stack;
+  std::sig_atomic_t m_ticksSampled = 0;
+  uint64_t m_samples = 0;
+  uint64_t m_scriptSelf = 0;
+  std::vector<Label> m_labels;
+  std::unordered_map<PyCallable*, size_t> m_labelOf;
+  std::unordered_map<std::string, size_t> m_labelNamed;
+  std::unordered_map<std::string, uint64_t> m_folded;
+  std::string m_key;
+  struct sigaction m_previousAction;
+};
+}  // namespace PyInterpreter
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Arena.hpp"
+#include "SourceBuffer.hpp"
+#include "Stmt.hpp"
+
+namespace PyInterpreter {
+// A parsed script. Every node reachable from statements lives in the arena,
+// so dropping the Program frees the whole tree in one operation. Token
+// lexemes inside the nodes point into source, which is released last.
+class Program {
+ public:
+  std::unique_ptr<SourceBuffer> source;
+  Arena arena;
+  std::vector<Stmt*> statements;
+};
+}  // namespace PyInterpreter
@@ -0,0 +1,612 @@
+#include "ProgramCache.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "Expr.hpp"
+#include "Stmt.hpp"
+
+using namespace PyInterpreter;
+
+namespace {
+const char kMagic[4] = {'P', 'Y', 'A', 'C'};
+
+struct Header {
+  char magic[4];
+  uint32_t version;
+  uint64_t sourceHash;
+  uint64_t sourceSize;
+  uint64_t payloadSize;
+  uint64_t payloadHash;
+};
+
+// One tag byte precedes every node; NONE stands for a null pointer.
+enum class Tag : uint8_t {
+  NONE,
+  ASSIGN,
+  LITERAL,
+  LOGICAL,
+  UNARY,
+  VARIABLE,
+  GROUPING,
+  BINARY,
+  CALL,
+  BLOCK,
+  IF_ELSE_BLOCK,
+  EXPRESSION,
+  RETURN,
+  FUNCTION,
+  IF,
+  PRINT,
+  VAR,
+  WHILE,
+  FOR,
+  LIST,
+  INDEX,
+  SET_INDEX,
+  METHOD_CALL
+};
+
+enum class LiteralTag : uint8_t { NONE, FALSE, TRUE, INT, BIGINT, STRING };
+
+const size_t kTokenTypes = static_cast<size_t>(Token::TokenType::ENDOFFILE) + 1;
+
+// Little-endian base 128, seven bits per byte.
+void putVarint(std::string& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+// Maps small negative numbers to small varints: 0, -1, 1, -2, ...
+uint64_t zigzag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ (value < 0 ? ~0ull : 0);
+}
+int64_t unzigzag(uint64_t bits) {
+  return static_cast<int64_t>((bits >> 1) ^ -(bits & 1));
+}
+
+class Writer : public Expr::Visitor, public Stmt::Visitor {
+ public:
+  Writer(std::string_view source) : m_source(source) {}
+
+  // Returns false if the tree holds a token that is not from the source.
+  bool write(const std::vector<Stmt*>& statements) {
+    varint(statements.size());
+    for (Stmt* stmt : statements) node(stmt);
+    return m_ok;
+  }
+  // The name table comes first, so the reader can intern names up front.
+  std::string payload() const {
+    std::string payload;
+    putVarint(payload, m_nameIndex.size());
+    payload += m_names;
+    payload += m_out;
+    return payload;
+  }
+
+  void visit(Assign& expr) {
+    tag(Tag::ASSIGN);
+    token(expr.name);
+    node(expr.value);
+  }
+  void visit(Literal& expr) {
+    tag(Tag::LITERAL);
+    const Value& value = expr.value;
+    if (value.isInt()) {
+      literalTag(LiteralTag::INT);
+      varint(zigzag(value.asInt()));
+    } else if (value.isBigInt()) {
+      literalTag(LiteralTag::BIGINT);
+      bytes(value.asBigInt().toString());
+    } else if (value.isString()) {
+      literalTag(LiteralTag::STRING);
+      bytes(value.asString());
+    } else if (value.isBool()) {
+      literalTag(value.asBool() ? LiteralTag::TRUE : LiteralTag::FALSE);
+    } else {
+      literalTag(LiteralTag::NONE);
+    }
+  }
+  void visit(Logical& expr) {
+    tag(Tag::LOGICAL);
+    node(expr.left);
+    token(expr.op);
+    node(expr.right);
+  }
+  void visit(Unary& expr) {
+    tag(Tag::UNARY);
+    token(expr.op);
+    node(expr.right);
+  }
+  void visit(Variable& expr) {
+    tag(Tag::VARIABLE);
+    token(expr.name);
+  }
+  void visit(Grouping& expr) {
+    tag(Tag::GROUPING);
+    node(expr.expression);
+  }
+  void visit(Binary& expr) {
+    tag(Tag::BINARY);
+    node(expr.left);
+    token(expr.op);
+    node(expr.right);
+  }
+  void visit(Call& expr) {
+    tag(Tag::CALL);
+    node(expr.callee);
+    token(expr.paren);
+    nodes(expr.arguments);
+  }
+  void visit(List& expr) {
+    tag(Tag::LIST);
+    token(expr.bracket);
+    nodes(expr.elements);
+  }
+  void visit(Index& expr) {
+    tag(Tag::INDEX);
+    node(expr.object);
+    token(expr.bracket);
+    node(expr.index);
+  }
+  void visit(SetIndex& expr) {
+    tag(Tag::SET_INDEX);
+    node(expr.object);
+    token(expr.bracket);
+    node(expr.index);
+    node(expr.value);
+  }
+  void visit(MethodCall& expr) {
+    tag(Tag::METHOD_CALL);
+    node(expr.object);
+    token(expr.name);
+    m_out.push_back(static_cast<char>(expr.method));
+    nodes(expr.arguments);
+  }
+
+  void visit(Block& stmt) {
+    tag(Tag::BLOCK);
+    nodes(stmt.statements);
+  }
+  void visit(IfElseBlock& stmt) {
+    tag(Tag::IF_ELSE_BLOCK);
+    nodes(stmt.statements);
+  }
+  void visit(Expression& stmt) {
+    tag(Tag::EXPRESSION);
+    node(stmt.expression);
+  }
+  void visit(ReturnStmt& stmt) {
+    tag(Tag::RETURN);
+    token(stmt.keyword);
+    node(stmt.value);
+  }
+  void visit(Function& stmt) {
+    tag(Tag::FUNCTION);
+    token(stmt.name);
+    varint(stmt.parameters.size());
+    for (const Token& parameter : stmt.parameters) token(parameter);
+    nodes(stmt.body);
+  }
+  void visit(If& stmt) {
+    tag(Tag::IF);
+    node(stmt.condition);
+    node(stmt.thenBranch);
+    node(stmt.elseBranch);
+  }
+  void visit(Print& stmt) {
+    tag(Tag::PRINT);
+    nodes(stmt.expressions);
+  }
+  void visit(Var& stmt) {
+    tag(Tag::VAR);
+    token(stmt.name);
+    node(stmt.initializer);
+  }
+  void visit(While& stmt) {
+    tag(Tag::WHILE);
+    node(stmt.condition);
+    nodes(stmt.body);
+  }
+  void visit(For& stmt) {
+    tag(Tag::FOR);
+    token(stmt.name);
+    token(stmt.range);
+    node(stmt.start);
+    node(stmt.stop);
+    node(stmt.step);
+    nodes(stmt.body);
+  }
+
+ private:
+  template <typename Node>
+  void node(Node* node) {
+    if (node == nullptr) return tag(Tag::NONE);
+    node->accept(*this);
+  }
+  template <typename Node>
+  void nodes(const std::vector<Node*>& nodes) {
+    varint(nodes.size());
+    for (Node* each : nodes) node(each);
+  }
+
+  void tag(Tag tag) { m_out.push_back(static_cast<char>(tag)); }
+  void literalTag(LiteralTag tag) { m_out.push_back(static_cast<char>(tag)); }
+  void bytes(std::string_view text) {
+    varint(text.size());
+    m_out.append(text);
+  }
+
+  // Type and line, then for an identifier its index in the name table,
+  // which gives its text, and for anything else its lexeme as an offset and
+  // length in the source. Tokens are written in nearly source order, so the
+  // line and offset are stored as differences from the previous token's.
+  void token(const Token& token) {
+    m_out.push_back(static_cast<char>(token.type));
+    varint(zigzag(static_cast<int64_t>(token.line) - m_line));
+    m_line = token.line;
+
+    const char* begin = m_source.data();
+    if (token.lexeme.data() < begin ||
+        token.lexeme.data() + token.lexeme.size() > begin + m_source.size()) {
+      m_ok = false;
+      return;
+    }
+    const uint64_t offset = token.lexeme.data() - begin;
+    if (token.type == Token::TokenType::IDENTIFIER) {
+      auto found = m_nameIndex.emplace(token.symbol, m_nameIndex.size());
+      if (found.second) {
+        putVarint(m_names, offset);
+        putVarint(m_names, token.lexeme.size());
+      }
+      return varint(found.first->second);
+    }
+    varint(zigzag(static_cast<int64_t>(offset) - m_offset));
+    varint(token.lexeme.size());
+    m_offset = offset;
+  }
+
+  void varint(uint64_t value) { putVarint(m_out, value); }
+
+  std::string_view m_source;
+  std::string m_out;
+  std::string m_names;
+  std::unordered_map<Symbol, size_t> m_nameIndex;
+  int64_t m_line = 0;
+  int64_t m_offset = 0;
+  bool m_ok = true;
+};
+
+// Decodes a payload written by Writer. Every read is bounds checked; any
+// inconsistency clears m_ok and the partial tree is abandoned to the arena.
+class Reader {
+ public:
+  Reader(std::string_view payload, std::string_view source, Arena& arena)
+      : m_next(payload.data()),
+        m_end(payload.data() + payload.size()),
+        m_source(source),
+        m_arena(arena) {}
+
+  bool read(std::vector<Stmt*>& statements) {
+    const uint64_t names = varint();
+    for (uint64_t i = 0; i < names && m_ok; i++) {
+      m_names.push_back(lexeme());
+      m_symbols.push_back(m_ok ? SymbolTable::instance().intern(m_names.back())
+                               : 0);
+    }
+    statements = stmts();
+    return m_ok && m_next == m_end;
+  }
+
+ private:
+  Expr* expr() {
+    switch (tag()) {
+      case Tag::NONE:
+        return nullptr;
+      case Tag::ASSIGN: {
+        Token name = token();
+        return m_arena.make<Assign>(name, expr());
+      }
+      case Tag::LITERAL:
+        return m_arena.make<Literal>(literal());
+      case Tag::LOGICAL: {
+        Expr* left = expr();
+        Token op = token();
+        return m_arena.make<Logical>(left, op, expr());
+      }
+      case Tag::UNARY: {
+        Token op = token();
+        return m_arena.make<Unary>(op, expr());
+      }
+      case Tag::VARIABLE:
+        return m_arena.make<Variable>(token());
+      case Tag::GROUPING:
+        return m_arena.make<Grouping>(expr());
+      case Tag::BINARY: {
+        Expr* left = expr();
+        Token op = token();
+        return m_arena.make<Binary>(left, op, expr());
+      }
+      case Tag::CALL: {
+        Expr* callee = expr();
+        Token paren = token();
+        return m_arena.make<Call>(callee, paren, exprs());
+      }
+      case Tag::LIST: {
+        Token bracket = token();
+        return m_arena.make<List>(bracket, exprs());
+      }
+      case Tag::INDEX: {
+        Expr* object = expr();
+        Token bracket = token();
+        return m_arena.make<Index>(object, bracket, expr());
+      }
+      case Tag::SET_INDEX: {
+        Expr* object = expr();
+        Token bracket = token();
+        Expr* index = expr();
+        return m_arena.make<SetIndex>(object, bracket, index, expr());
+      }
+      case Tag::METHOD_CALL: {
+        Expr* object = expr();
+        Token name = token();
+        if (byte() != static_cast<uint8_t>(MethodCall::Method::APPEND)) {
+          return fail<Expr>();
+        }
+        std::vector<Expr*> arguments = exprs();
+        if (arguments.size() != 1) return fail<Expr>();
+        return m_arena.make<MethodCall>(object, name,
+                                        MethodCall::Method::APPEND, arguments);
+      }
+      default:
+        return fail<Expr>();
+    }
+  }
+
+  Stmt* stmt() {
+    switch (tag()) {
+      case Tag::NONE:
+        return nullptr;
+      case Tag::BLOCK:
+        return m_arena.make<Block>(stmts());
+      case Tag::IF_ELSE_BLOCK:
+        return m_arena.make<IfElseBlock>(stmts());
+      case Tag::EXPRESSION:
+        return m_arena.make<Expression>(expr());
+      case Tag::RETURN: {
+        Token keyword = token();
+        return m_arena.make<ReturnStmt>(keyword, expr());
+      }
+      case Tag::FUNCTION: {
+        Token name = token();
+        std::vector<Token> parameters;
+        const uint64_t count = varint();
+        for (uint64_t i = 0; i < count && m_ok; i++) {
+          parameters.push_back(token());
+        }
+        return m_arena.make<Function>(name, parameters, stmts());
+      }
+      case Tag::IF: {
+        Expr* condition = expr();
+        Stmt* thenBranch = stmt();
+        return m_arena.make<If>(condition, thenBranch, stmt());
+      }
+      case Tag::PRINT:
+        return m_arena.make<Print>(exprs());
+      case Tag::VAR: {
+        Token name = token();
+        return m_arena.make<Var>(name, expr());
+      }
+      case Tag::WHILE: {
+        Expr* condition = expr();
+        return m_arena.make<While>(condition, stmts());
+      }
+      case Tag::FOR: {
+        Token name = token();
+        Token range = token();
+        Expr* start = expr();
+        Expr* stop = expr();
+        Expr* step = expr();
+        return m_arena.make<For>(name, range, start, stop, step, stmts());
+      }
+      default:
+        return fail<Stmt>();
+    }
+  }
+
+  std::vector<Expr*> exprs() {
+    std::vector<Expr*> exprs;
+    const uint64_t count = varint();
+    for (uint64_t i = 0; i < count && m_ok; i++) exprs.push_back(expr());
+    return exprs;
+  }
+  std::vector<Stmt*> stmts() {
+    std::vector<Stmt*> stmts;
+    const uint64_t count = varint();
+    for (uint64_t i = 0; i < count && m_ok; i++) stmts.push_back(stmt());
+    return stmts;
+  }
+
+  Value literal() {
+    switch (static_cast<LiteralTag>(byte())) {
+      case LiteralTag::NONE:
+        return Value::none();
+      case LiteralTag::FALSE:
+        return Value::boolean(false);
+      case LiteralTag::TRUE:
+        return Value::boolean(true);
+      case LiteralTag::INT:
+        return Value::integer(unzigzag(varint()));
+      case LiteralTag::BIGINT:
+        return Value::bigint(BigInt::parse(bytes()));
+      case LiteralTag::STRING:
+        return Value::string(std::string(bytes()));
+    }
+    m_ok = false;
+    return Value::none();
+  }
+
+  Token token() {
+    const uint8_t type = byte();
+    m_line += unzigzag(varint());
+    if (type >= kTokenTypes) m_ok = false;
+    if (static_cast<Token::TokenType>(type) == Token::TokenType::IDENTIFIER) {
+      const uint64_t name = varint();
+      if (name >= m_symbols.size()) m_ok = false;
+      if (!m_ok) return Token(Token::TokenType::ENDOFFILE, "", 0);
+      return Token(Token::TokenType::IDENTIFIER, m_names[name],
+                   static_cast<int>(m_line), m_symbols[name]);
+    }
+    m_offset += unzigzag(varint());
+    std::string_view text = slice(m_offset, varint());
+    if (!m_ok) return Token(Token::TokenType::ENDOFFILE, "", 0);
+    return Token(static_cast<Token::TokenType>(type), text,
+                 static_cast<int>(m_line));
+  }
+
+  std::string_view lexeme() {
+    const uint64_t offset = varint();
+    return slice(offset, varint());
+  }
+  std::string_view slice(uint64_t offset, uint64_t size) {
+    if (offset > m_source.size() || size > m_source.size() - offset) {
+      m_ok = false;
+      return std::string_view();
+    }
+    return m_source.substr(offset, size);
+  }
+
+  std::string_view bytes() {
+    const uint64_t size = varint();
+    if (size > static_cast<uint64_t>(m_end - m_next)) {
+      m_ok = false;
+      return std::string_view();
+    }
+    std::string_view text(m_next, size);
+    m_next += size;
+    return text;
+  }
+
+  Tag tag() { return static_cast<Tag>(byte()); }
+  uint8_t byte() {
+    if (m_next == m_end) {
+      m_ok = false;
+      return 0;
+    }
+    return static_cast<uint8_t>(*m_next++);
+  }
+  uint64_t varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      const uint8_t next = byte();
+      value |= static_cast<uint64_t>(next & 0x7f) << shift;
+      if ((next & 0x80) == 0) return value;
+    }
+    m_ok = false;
+    return 0;
+  }
+
+  template <typename Node>
+  Node* fail() {
+    m_ok = false;
+    return nullptr;
+  }
+
+  const char* m_next;
+  const char* const m_end;
+  std::string_view m_source;
+  Arena& m_arena;
+  std::vector<std::string_view> m_names;
+  std::vector<Symbol> m_symbols;
+  int64_t m_line = 0;
+  int64_t m_offset = 0;
+  bool m_ok = true;
+};
+}  // namespace
+
+uint64_t ProgramCache::contentHash(std::string_view data) {
+  uint64_t hash = 14695981039346656037ull;
+  size_t i = 0;
+  for (; i + 8 <= data.size(); i += 8) {
+    uint64_t word;
+    std::memcpy(&word, data.data() + i, sizeof(word));
+    hash = (hash ^ word) * 1099511628211ull;
+  }
+  for (; i < data.size(); i++) {
+    hash = (hash ^ static_cast<uint8_t>(data[i])) * 1099511628211ull;
+  }
+  return hash;
+}
+
+std::string ProgramCache::path(uint64_t hash) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.pyac",
+                static_cast<unsigned long long>(hash));
+  return m_directory + "/" + name;
+}
+
+bool ProgramCache::load(Program& program) {
+  const std::string_view source = program.source->text();
+  const uint64_t hash = contentHash(source);
+  std::unique_ptr<SourceBuffer> entry = SourceBuffer::open(path(hash));
+  if (entry == nullptr) return false;
+
+  const std::string_view data = entry->text();
+  Header header;
+  if (data.size() < sizeof(header)) return false;
+  std::memcpy(&header, data.data(), sizeof(header));
+  const std::string_view payload = data.substr(sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion || header.sourceHash != hash ||
+      header.sourceSize != source.size() ||
+      header.payloadSize != payload.size() ||
+      header.payloadHash != contentHash(payload)) {
+    return false;
+  }
+
+  std::vector<Stmt*> statements;
+  if (!Reader(payload, source, program.arena).read(statements)) return false;
+  program.statements = std::move(statements);
+  return true;
+}
+
+void ProgramCache::store(const Program& program) {
+  const std::string_view source = program.source->text();
+  Writer writer(source);
+  if (!writer.write(program.statements)) return;
+
+  const std::string payload = writer.payload();
+
+  Header header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.sourceHash = contentHash(source);
+  header.sourceSize = source.size();
+  header.payloadSize = payload.size();
+  header.payloadHash = contentHash(payload);
+
+  // Written under a temporary name and renamed into place, so a concurrent
+  // run never maps a half-written entry. The name is unique per writer:
+  // --jobs threads storing the same script share a process id.
+  const std::string target = path(header.sourceHash);
+  std::string temporary = target + ".XXXXXX";
+  int fd = ::mkstemp(&temporary[0]);
+  if (fd < 0) return;
+  bool written = ::fchmod(fd, 0644) == 0 &&
+                 ::write(fd, &header, sizeof(header)) == sizeof(header) &&
+                 ::write(fd, payload.data(), payload.size()) ==
+                     static_cast<ssize_t>(payload.size());
+  written = ::close(fd) == 0 && written;
+  if (!written || std::rename(temporary.c_str(), target.c_str()) != 0) {
+    std::remove(temporary.c_str());
+  }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "Program.hpp"
+
+namespace PyInterpreter {
+// On-disk cache of parsed programs (--cache DIR). Each entry holds the
+// statements exactly as the Parser produced them, before the Resolver or
+// Optimizer, in a compact binary form. Entries are named after a hash of
+// the script's contents, so an edited script simply misses. Token lexemes
+// are stored as offsets into the script, which must be read anyway to hash
+// it, and identifiers are interned once per distinct name on load.
+//
+// Every entry starts with a magic number and kVersion, and carries the
+// hash of its own payload. A file that is truncated, corrupt or from
+// another version is ignored, and the next store() replaces it.
+class ProgramCache {
+ public:
+  // Bump whenever the encoding, Token::TokenType or the node classes change.
+  static const uint32_t kVersion = 3;
+
+  explicit ProgramCache(std::string directory)
+      : m_directory(std::move(directory)) {}
+
+  // Fills program.statements, allocated from program.arena, from the entry
+  // for program.source. Returns false if there is no usable entry.
+  bool load(Program& program);
+  // Records program.statements as parsed from program.source. The cache is
+  // only an optimization, so failing to write is not an error.
+  void store(const Program& program);
+
+  // FNV-1a taken over 64-bit words rather than bytes.
+  static uint64_t contentHash(std::string_view data);
+
+ private:
+  std::string path(uint64_t hash) const;
+
+  std::string m_directory;
+};
+}  // namespace PyInterpreter
@@ -0,0 +1,211 @@
+#include "Purity.hpp"
+
+using namespace PyInterpreter;
+
+namespace {
+// False only when expr certainly evaluates to something other than a list.
+bool mayBeList(const Expr* expr) {
+  if (expr == nullptr || dynamic_cast<const Literal*>(expr) != nullptr ||
+      dynamic_cast<const Unary*>(expr) != nullptr) {
+    return false;
+  }
+  if (const Grouping* grouping = dynamic_cast<const Grouping*>(expr)) {
+    return mayBeList(grouping->expression);
+  }
+  if (const Logical* logical = dynamic_cast<const Logical*>(expr)) {
+    return mayBeList(logical->left) || mayBeList(logical->right);
+  }
+  if (const Binary* binary = dynamic_cast<const Binary*>(expr)) {
+    // Only + can produce a list, by concatenating two.
+    return binary->op.type == Token::TokenType::PLUS &&
+           mayBeList(binary->left) && mayBeList(binary->right);
+  }
+  return true;
+}
+}  // namespace
+
+void PurityAnalysis::analyze(const std::vector<Stmt*>& statements) {
+  walk(statements);
+
+  auto boundOnce = [this](Symbol name) {
+    auto found = m_bindings.find(name);
+    return found != m_bindings.end() && found->second == 1;
+  };
+  for (FunctionInfo& info : m_functions) {
+    for (Symbol name : info.globalsRead) {
+      if (!boundOnce(name)) info.impure = true;
+    }
+    for (Symbol name : info.callees) {
+      if (!boundOnce(name) || m_definitions.count(name) == 0) {
+        info.impure = true;
+      }
+    }
+  }
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (FunctionInfo& info : m_functions) {
+      if (info.impure) continue;
+      for (Symbol name : info.callees) {
+        if (m_functions[m_indices[m_definitions[name]]].impure) {
+          info.impure = true;
+          changed = true;
+          break;
+        }
+      }
+    }
+  }
+
+  for (FunctionInfo& info : m_functions) {
+    info.declaration->pure = !info.impure;
+  }
+}
+
+void PurityAnalysis::bindGlobal(Symbol name, bool mayBeList) {
+  m_bindings[name] += m_loops > 0 || mayBeList ? 2 : 1;
+}
+
+void PurityAnalysis::markImpure() {
+  if (m_current >= 0) m_functions[m_current].impure = true;
+}
+
+void PurityAnalysis::visit(Assign& expr) {
+  if (expr.slot < 0) {
+    bindGlobal(expr.name.symbol, mayBeList(expr.value));
+    markImpure();
+  }
+  expr.value->accept(*this);
+}
+
+void PurityAnalysis::visit(Literal&) {}
+
+void PurityAnalysis::visit(Logical& expr) {
+  expr.left->accept(*this);
+  expr.right->accept(*this);
+}
+
+void PurityAnalysis::visit(Unary& expr) { expr.right->accept(*this); }
+
+void PurityAnalysis::visit(Variable& expr) {
+  if (expr.slot < 0 && m_current >= 0) {
+    m_functions[m_current].globalsRead.push_back(expr.name.symbol);
+  }
+}
+
+void PurityAnalysis::visit(Grouping& expr) { expr.expression->accept(*this); }
+
+void PurityAnalysis::visit(Binary& expr) {
+  expr.left->accept(*this);
+  expr.right->accept(*this);
+}
+
+void PurityAnalysis::visit(Call& expr) {
+  // Only calls through a global name can be tied to a declaration.
+  Variable* callee = dynamic_cast<Variable*>(expr.callee);
+  if (callee != nullptr && callee->slot < 0) {
+    if (m_current >= 0) {
+      m_functions[m_current].callees.push_back(callee->name.symbol);
+    }
+  } else {
+    markImpure();
+    expr.callee->accept(*this);
+  }
+  for (Expr* arg : expr.arguments) arg->accept(*this);
+}
+
+// A memoized call would hand every caller the same list, and list contents
+// can change between calls, so any function touching lists is impure.
+void PurityAnalysis::visit(List& expr) {
+  markImpure();
+  for (Expr* element : expr.elements) element->accept(*this);
+}
+
+void PurityAnalysis::visit(Index& expr) {
+  markImpure();
+  expr.object->accept(*this);
+  expr.index->accept(*this);
+}
+
+void PurityAnalysis::visit(SetIndex& expr) {
+  markImpure();
+  expr.value->accept(*this);
+  expr.object->accept(*this);
+  expr.index->accept(*this);
+}
+
+void PurityAnalysis::visit(MethodCall& expr) {
+  markImpure();
+  expr.object->accept(*this);
+  for (Expr* arg : expr.arguments) arg->accept(*this);
+}
+
+void PurityAnalysis::visit(Block& stmt) { walk(stmt.statements); }
+
+void PurityAnalysis::visit(IfElseBlock& stmt) { walk(stmt.statements); }
+
+void PurityAnalysis::visit(Expression& stmt) {
+  stmt.expression->accept(*this);
+}
+
+void PurityAnalysis::visit(Function& stmt) {
+  // Each execution of a nested def creates a new function object.
+  markImpure();
+  if (stmt.slot < 0) {
+    bindGlobal(stmt.name.symbol);
+    m_definitions[stmt.name.symbol] = &stmt;
+  }
+
+  FunctionInfo info;
+  info.declaration = &stmt;
+  m_indices[&stmt] = m_functions.size();
+  m_functions.push_back(std::move(info));
+
+  const int enclosing = m_current;
+  m_current = m_functions.size() - 1;
+  walk(stmt.body);
+  m_current = enclosing;
+}
+
+void PurityAnalysis::visit(If& stmt) {
+  stmt.condition->accept(*this);
+  stmt.thenBranch->accept(*this);
+  if (stmt.elseBranch != nullptr) stmt.elseBranch->accept(*this);
+}
+
+void PurityAnalysis::visit(ReturnStmt& stmt) {
+  if (stmt.value != nullptr) stmt.value->accept(*this);
+}
+
+void PurityAnalysis::visit(Print& stmt) {
+  markImpure();
+  for (Expr* expr : stmt.expressions) expr->accept(*this);
+}
+
+void PurityAnalysis::visit(Var& stmt) {
+  if (stmt.slot < 0) {
+    bindGlobal(stmt.name.symbol, mayBeList(stmt.initializer));
+    markImpure();
+  }
+  if (stmt.initializer != nullptr) stmt.initializer->accept(*this);
+}
+
+void PurityAnalysis::visit(While& stmt) {
+  stmt.condition->accept(*this);
+  m_loops++;
+  walk(stmt.body);
+  m_loops--;
+}
+
+void PurityAnalysis::visit(For& stmt) {
+  if (stmt.start != nullptr) stmt.start->accept(*this);
+  stmt.stop->accept(*this);
+  if (stmt.step != nullptr) stmt.step->accept(*this);
+  m_loops++;
+  if (stmt.slot < 0) {
+    bindGlobal(stmt.name.symbol);
+    markImpure();
+  }
+  walk(stmt.body);
+  m_loops--;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "Expr.hpp"
+#include "Stmt.hpp"
+#include "SymbolTable.hpp"
+
+namespace PyInterpreter {
+// Marks Function declarations whose result depends only on their
+// arguments, so calls to them can be memoized. A function is pure when its
+// body
+//  - does not print,
+//  - does not bind globals or define nested functions,
+//  - reads only globals that are bound exactly once in the program, to a
+//    value that cannot be a list, and
+//  - calls only globals bound once to a def that is itself pure.
+// Mutually recursive functions start out pure and are demoted until the
+// marking is stable. Runs after the Resolver, which separates locals from
+// globals.
+class PurityAnalysis : public Expr::Visitor, public Stmt::Visitor {
+ public:
+  void analyze(const std::vector<Stmt*>& statements);
+
+  void visit(Assign& expr);
+  void visit(Literal& expr);
+  void visit(Logical& expr);
+  void visit(Unary& expr);
+  void visit(Variable& expr);
+  void visit(Grouping& expr);
+  void visit(Binary& expr);
+  void visit(Call& expr);
+  void visit(List& expr);
+  void visit(Index& expr);
+  void visit(SetIndex& expr);
+  void visit(MethodCall& expr);
+
+  void visit(Block& stmt);
+  void visit(IfElseBlock& stmt);
+  void visit(Expression& stmt);
+  void visit(Function& stmt);
+  void visit(If& stmt);
+  void visit(ReturnStmt& stmt);
+  void visit(Print& stmt);
+  void visit(Var& stmt);
+  void visit(While& stmt);
+  void visit(For& stmt);
+
+ private:
+  struct FunctionInfo {
+    Function* declaration;
+    bool impure = false;
+    std::vector<Symbol> callees;
+    std::vector<Symbol> globalsRead;
+  };
+
+  void walk(const std::vector<Stmt*>& stmts) {
+    for (Stmt* stmt : stmts) stmt->accept(*this);
+  }
+  // A binding to a value that may be a list counts as two, since the list
+  // may change after it was bound.
+  void bindGlobal(Symbol name, bool mayBeList = false);
+  void markImpure();
+
+  std::vector<FunctionInfo> m_functions;
+  std::unordered_map<const Function*, int> m_indices;
+  // Index into m_functions of the body being walked; -1 at the top level.
+  int m_current = -1;
+  // Loops enclosing the statement being walked. A binding inside one counts
+  // as two, since it may run any number of times.
+  int m_loops = 0;
+  std::unordered_map<Symbol, int> m_bindings;
+  std::unordered_map<Symbol, Function*> m_definitions;
+};
+}  // namespace PyInterpreter
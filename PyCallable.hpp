@@ -3,14 +3,21 @@
 #include <vector>
 #include <string>
 
+#include "Value.hpp"
+
 namespace PyInterpreter {
 class Interpreter;
 class PyCallable {
  public:
+  virtual ~PyCallable() {}
   virtual int arity() = 0;
-  virtual std::string call(Interpreter* interpreter,
-                    std::vector<std::string> arguments) = 0;
+  // Number of slots the callee needs in its frame, arguments first.
+  virtual int frameSize() { return arity(); }
+  // frame holds the arguments in its first arity() slots, followed by
+  // frameSize() - arity() none slots the callee may use for its locals.
+  virtual Value call(Interpreter* interpreter, Value* frame) = 0;
+  virtual std::string toString() = 0;
 };
 
 
-}  // namespace PyInterpreter
\ No newline at end of file
+}  // namespace PyInterpreter
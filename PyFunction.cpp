@@ -1,18 +1,95 @@
 #include "PyFunction.hpp"
 
+#include <algorithm>
+
 using namespace PyInterpreter;
 
-std::string PyFunction::call(Interpreter* interpreter,
-                      std::vector<std::string> arguments) {
-  Environment environment = new Environment(interpreter->getGlobals());
-  for (int i = 0; i < declaration.parameters.size(); i++) {
-    environment.assign(declaration.parameters[i], arguments[i]);
+PyFunction::PyFunction(const Function& func) : declaration(func) {
+  m_memoize = declaration.pure && arity() <= kMaxMemoArgs;
+}
+
+Value PyFunction::call(Interpreter* interpreter, Value* frame) {
+  Value result;
+  uint64_t hash;
+  if (!m_memoize || !memoHash(frame, hash)) {
+    run(interpreter, frame, result);
+    return result;
+  }
+  if (m_memo == nullptr) growMemo();
+
+  const int argc = arity();
+  const MemoEntry& cached = m_memo[hash & (m_memoCapacity - 1)];
+  if (cached.filled && std::equal(frame, frame + argc, cached.args)) {
+    m_memoHits++;
+    return cached.result;
+  }
+  m_memoMisses++;
+
+  // The body may reassign its parameters, so the key is copied up front.
+  Value args[kMaxMemoArgs];
+  std::copy(frame, frame + argc, args);
+  // Failed calls and tail calls have no result to remember yet.
+  if (run(interpreter, frame, result) != Completion::NORMAL) return result;
+
+  // Recursive calls may have grown the table while the body ran.
+  if (m_memoFilled * 2 >= m_memoCapacity && m_memoCapacity < kMaxMemoEntries) {
+    growMemo();
+  }
+  MemoEntry& entry = m_memo[hash & (m_memoCapacity - 1)];
+  if (!entry.filled) m_memoFilled++;
+  entry.filled = true;
+  std::move(args, args + argc, entry.args);
+  entry.result = result;
+  return result;
+}
+
+void PyFunction::growMemo() {
+  std::unique_ptr<MemoEntry[]> old = std::move(m_memo);
+  const size_t oldCapacity = m_memoCapacity;
+  m_memoCapacity = old == nullptr ? kInitialMemoEntries : oldCapacity * 2;
+  m_memo.reset(new MemoEntry[m_memoCapacity]);
+  m_memoFilled = 0;
+
+  const int argc = arity();
+  for (size_t i = 0; i < oldCapacity; i++) {
+    if (!old[i].filled) continue;
+    uint64_t hash;
+    memoHash(old[i].args, hash);
+    MemoEntry& entry = m_memo[hash & (m_memoCapacity - 1)];
+    if (!entry.filled) m_memoFilled++;
+    entry.filled = true;
+    std::move(old[i].args, old[i].args + argc, entry.args);
+    entry.result = std::move(old[i].result);
+  }
+}
+
+Completion PyFunction::run(Interpreter* interpreter, Value* frame,
+                           Value& result) {
+  Completion completion = interpreter->executeBlock(declaration.body, frame);
+  if (completion == Completion::RETURN) {
+    result = interpreter->takeReturnValue();
+    return Completion::NORMAL;
   }
+  return completion;
+}
 
-  try {
-    interpreter->executeBlock(declaration.body, environment);
-  } catch(ReturnObj* e) {
-    return e->value;
+bool PyFunction::memoHash(const Value* args, uint64_t& hash) const {
+  hash = 14695981039346656037ull;
+  for (size_t i = 0; i < declaration.parameters.size(); i++) {
+    const Value& arg = args[i];
+    uint64_t bits;
+    if (arg.isInt()) {
+      bits = arg.asInt();
+    } else if (arg.isBool()) {
+      bits = arg.asBool();
+    } else if (arg.isNone()) {
+      bits = 0;
+    } else {
+      return false;
+    }
+    hash = (hash ^ static_cast<uint64_t>(arg.type())) * 1099511628211ull;
+    hash = (hash ^ bits) * 1099511628211ull;
   }
-  return "";
-}
\ No newline at end of file
+  hash ^= hash >> 32;
+  return true;
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
 
 #include "Interpreter.hpp"
@@ -9,15 +11,50 @@
 
 namespace PyInterpreter {
 class Interpreter;
+enum class Completion;
 class PyFunction : public PyCallable {
  public:
-  PyFunction(const Function& func) : declaration(func) {}
+  PyFunction(const Function& func);
 
-  std::string call(Interpreter* interpreter, std::vector<std::string> arguments);
+  Value call(Interpreter* interpreter, Value* frame);
 
   int arity() { return declaration.parameters.size(); }
+  int frameSize() { return declaration.numLocals; }
+  std::string toString() {
+    return "<fn " + std::string(declaration.name.lexeme) + ">";
+  }
+
+  std::string_view name() const { return declaration.name.lexeme; }
+  int line() const { return declaration.name.line; }
+  bool memoized() const { return m_memoize; }
+  uint64_t memoHits() const { return m_memoHits; }
+  uint64_t memoMisses() const { return m_memoMisses; }
 
  private:
-  const Function declaration;
+  // Pure functions taking at most kMaxMemoArgs int, bool or none arguments
+  // remember results in a direct-mapped table; a colliding call evicts the
+  // previous entry. The table starts small, since most functions are called
+  // with few distinct arguments, and doubles at half load up to a bound.
+  static const int kMaxMemoArgs = 4;
+  static const size_t kInitialMemoEntries = 8;
+  static const size_t kMaxMemoEntries = 1024;
+  struct MemoEntry {
+    bool filled = false;
+    Value args[kMaxMemoArgs];
+    Value result;
+  };
+
+  Completion run(Interpreter* interpreter, Value* frame, Value& result);
+  bool memoHash(const Value* args, uint64_t& hash) const;
+  void growMemo();
+
+  // Owned by the Program's arena, which outlives the run.
+  const Function& declaration;
+  bool m_memoize = false;
+  std::unique_ptr<MemoEntry[]> m_memo;
+  size_t m_memoCapacity = 0;
+  size_t m_memoFilled = 0;
+  uint64_t m_memoHits = 0;
+  uint64_t m_memoMisses = 0;
 };
-}  // namespace PyInterpreter
\ No newline at end of file
+}  // namespace PyInterpreter
@@ -1,23 +1,247 @@
 #include "Python.hpp"
 
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
 using namespace PyInterpreter;
 
 void Python::run(std::string file) {
-  std::ifstream ifstr(file);
-  std::ostringstream buffer;
-  buffer << ifstr.rdbuf();
-  executeCode(buffer.str());
+  OutputSink out(STDOUT_FILENO, m_options.flushPolicy, m_options.asyncOutput);
+  run(file, out);
+}
+
+void Python::run(const std::string& file, OutputSink& out) const {
+  Program program;
+  program.source = SourceBuffer::open(file);
+  if (program.source == nullptr) {
+    out.flush();
+    std::cerr << "Could not open " << file << std::endl;
+    return;
+  }
+  OutputSink::StreamBuffer buffer(out);
+  std::ostream messages(&buffer);
+  if (m_options.stream && !m_options.useVM) {
+    streamCode(program, out, messages);
+  } else {
+    executeCode(program, out, messages);
+  }
+}
+
+void Python::runAll(const std::vector<std::string>& files, int jobs) {
+  // The profiler's timer and signal handler are process-wide.
+  Options options = m_options;
+  if (!options.profileFile.empty()) {
+    std::cerr << "--profile is ignored with --jobs" << std::endl;
+    options.profileFile.clear();
+  }
+  const Python python(options);
+
+  // Workers claim files in order and leave each one's output in its slot.
+  std::vector<std::string> outputs(files.size());
+  std::vector<bool> finished(files.size());
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::atomic<size_t> next(0);
+  auto work = [&] {
+    for (size_t i; (i = next.fetch_add(1)) < files.size();) {
+      std::string output;
+      {
+        OutputSink capture(output);
+        try {
+          python.run(files[i], capture);
+        } catch (const std::exception& e) {
+          capture.write(e.what());
+          capture.endLine();
+        }
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      outputs[i] = std::move(output);
+      finished[i] = true;
+      changed.notify_one();
+    }
+  };
 
-  ifstr.close();
+  std::vector<std::thread> workers;
+  const size_t threads = std::min<size_t>(std::max(jobs, 1), files.size());
+  for (size_t i = 0; i < threads; i++) workers.emplace_back(work);
+
+  OutputSink out(STDOUT_FILENO, m_options.flushPolicy, m_options.asyncOutput);
+  for (size_t i = 0; i < files.size(); i++) {
+    std::string output;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      changed.wait(lock, [&] { return finished[i]; });
+      output = std::move(outputs[i]);
+    }
+    out.write(output);
+    out.flush();
+  }
+  for (std::thread& worker : workers) worker.join();
 }
 
-void Python::executeCode(std::string code) {
-  Interpreter interpreter = Interpreter();
-  Scanner scanner = Scanner(code);
+bool Python::parse(Program& program, std::ostream& messages) const {
+  ProgramCache cache(m_options.cacheDirectory);
+  const bool caching = !m_options.cacheDirectory.empty();
+  if (caching && cache.load(program)) return true;
+
+  Scanner scanner = Scanner(program.source->text(), messages);
   std::vector<Token> tokens = scanner.scanTokens();
 
-  Parser parser = Parser(tokens);
-  std::vector<Stmt*> statements = parser.parse();
+  Parser parser = Parser(std::move(tokens), program.arena, messages);
+  program.statements = parser.parse();
+  if (parser.hadError()) return false;
+  if (caching) cache.store(program);
+  return true;
+}
+
+std::unique_ptr<Script> Python::load(const std::string& file) const {
+  std::unique_ptr<Script> script(new Script(
+      STDOUT_FILENO, m_options.flushPolicy, m_options.maxDepth));
+  Program& program = script->m_program;
+  program.source = SourceBuffer::open(file);
+  if (program.source == nullptr) {
+    throw std::runtime_error("Could not open " + file);
+  }
+  std::ostringstream messages;
+  if (!prepare(program, messages)) {
+    std::string error = messages.str();
+    if (!error.empty() && error.back() == '\n') error.pop_back();
+    throw std::runtime_error(error);
+  }
+
+  if (m_options.jit) script->m_interpreter.setJit(&script->m_jit);
+  std::string error;
+  if (!script->m_interpreter.run(program.statements, error)) {
+    throw std::runtime_error(error);
+  }
+  return script;
+}
+
+bool Python::prepare(Program& program, std::ostream& messages) const {
+  if (!parse(program, messages)) return false;
+  Resolver().resolve(program.statements);
+  if (m_options.optimize) {
+    Optimizer optimizer(program.arena);
+    optimizer.optimize(program.statements);
+    std::cerr << "Optimizer removed " << optimizer.removedNodes() << " nodes"
+              << std::endl;
+  }
+
+  if (m_options.memoize && !m_options.useVM) {
+    PurityAnalysis().analyze(program.statements);
+  }
+  return true;
+}
+
+void Python::executeCode(Program& program, OutputSink& out,
+                         std::ostream& messages) const {
+  if (!prepare(program, messages)) return;
+
+  if (m_options.useVM) {
+    if (!m_options.profileFile.empty()) {
+      std::cerr << "--profile is only supported by the tree interpreter"
+                << std::endl;
+    }
+    if (m_options.jit) {
+      std::cerr << "--jit is only supported by the tree interpreter"
+                << std::endl;
+    }
+    std::unique_ptr<CompiledProgram> compiled;
+    try {
+      compiled = Compiler().compile(program.statements);
+    } catch (const std::runtime_error& e) {
+      messages << e.what() << std::endl;
+      return;
+    }
+    VM(out, m_options.maxDepth).interpret(*compiled);
+    return;
+  }
+
+  Interpreter interpreter(out, m_options.maxDepth);
+  Jit jit;
+  if (m_options.jit) interpreter.setJit(&jit);
+  if (m_options.profileFile.empty()) {
+    interpreter.interpret(program.statements);
+  } else {
+    Profiler profiler;
+    interpreter.setProfiler(&profiler);
+    profiler.start();
+    interpreter.interpret(program.statements);
+    profiler.stop();
+    out.flush();
+    writeProfile(profiler);
+  }
+  if (m_options.memoStats) {
+    out.flush();
+    interpreter.printMemoStats(std::cerr);
+  }
+  if (m_options.jitStats) {
+    out.flush();
+    jit.printStats(std::cerr);
+  }
+}
+
+void Python::streamCode(Program& program, OutputSink& out,
+                        std::ostream& messages) const {
+  if (m_options.optimize) {
+    std::cerr << "-O is ignored with --stream" << std::endl;
+  }
+
+  // Each statement is parsed into scratch and freed once it has run, unless
+  // it declared a function, whose body has to outlive it in the program.
+  // A freed statement's global cache entries are reused by the next one.
+  // Memoization is off: purity depends on bindings that are yet to be read.
+  Scanner scanner(program.source->text(), messages);
+  Arena scratch;
+  Parser parser(scanner, scratch, messages);
+  Resolver resolver;
+  Interpreter interpreter(out, m_options.maxDepth);
+  Jit jit;
+  if (m_options.jit) interpreter.setJit(&jit);
+  Profiler profiler;
+  const bool profiling = !m_options.profileFile.empty();
+  if (profiling) {
+    interpreter.setProfiler(&profiler);
+    profiler.start();
+  }
+
+  int functions = 0;
+  while (Stmt* stmt = parser.parseStatement()) {
+    const int cacheEntries = resolver.cacheEntries();
+    resolver.resolve(stmt);
+    const bool running = interpreter.interpret(stmt);
+    if (parser.functionsParsed() != functions) {
+      functions = parser.functionsParsed();
+      program.arena.adopt(scratch);
+    } else {
+      scratch.reset();
+      resolver.releaseCacheEntries(cacheEntries);
+      interpreter.releaseGlobalCache(cacheEntries);
+    }
+    if (!running) break;
+  }
+
+  if (profiling) {
+    profiler.stop();
+    out.flush();
+    writeProfile(profiler);
+  }
+  if (m_options.jitStats) {
+    out.flush();
+    jit.printStats(std::cerr);
+  }
+}
 
-  interpreter.interpret(statements);
+void Python::writeProfile(const Profiler& profiler) const {
+  std::ofstream out(m_options.profileFile);
+  if (!out) {
+    std::cerr << "Could not write " << m_options.profileFile << std::endl;
+  } else {
+    profiler.writeFolded(out);
+  }
+  profiler.writeTable(std::cerr, kProfileTableRows);
 }
\ No newline at end of file
@@ -3,21 +3,88 @@
 #pragma once
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <vector>
 
+#include "Compiler.hpp"
 #include "Interpreter.hpp"
+#include "Jit.hpp"
+#include "Optimizer.hpp"
+#include "OutputSink.hpp"
 #include "Scanner.hpp"
 #include "Parser.hpp"
+#include "Profiler.hpp"
+#include "Purity.hpp"
+#include "Program.hpp"
+#include "ProgramCache.hpp"
+#include "Resolver.hpp"
+#include "Script.hpp"
+#include "VM.hpp"
 
 namespace PyInterpreter {
+struct Options {
+  // Run on the bytecode VM instead of the tree-walking interpreter.
+  bool useVM = false;
+  // Fold constants and prune dead branches before running (-O).
+  bool optimize = false;
+  // Cache results of pure functions in the tree interpreter (--no-memo).
+  bool memoize = true;
+  // Print memo cache hit and miss counts to stderr (--memo-stats).
+  bool memoStats = false;
+  // Active calls allowed before a recursion depth error (--max-depth N).
+  int maxDepth = kDefaultMaxDepth;
+  // Sample the tree interpreter's calls and write folded stacks to this
+  // file, with a summary table on stderr (--profile FILE).
+  std::string profileFile;
+  // When buffered print output is written (--flush line|size|exit).
+  OutputSink::FlushPolicy flushPolicy = OutputSink::FlushPolicy::AUTO;
+  // Write print output from a background thread (--async-output).
+  bool asyncOutput = false;
+  // Run each top-level statement as soon as it is parsed and free it
+  // afterwards, on the tree interpreter only (--stream).
+  bool stream = false;
+  // Directory of parsed programs reused across runs (--cache DIR); no
+  // caching when empty. --stream does not use it.
+  std::string cacheDirectory;
+  // Compile integer-only functions to native code on the tree interpreter
+  // (--jit).
+  bool jit = false;
+  // Print each compiled function's native and bailed-out call counts to
+  // stderr (--jit-stats).
+  bool jitStats = false;
+};
+
 class Python {
  public:
+  Python(const Options& options = Options()) : m_options(options) {}
   void run(std::string file);
+  // Runs file with its output, syntax errors included, going to out. Each
+  // call has its own program and interpreter, so calls on separate threads
+  // are independent.
+  void run(const std::string& file, OutputSink& out) const;
+  // Runs files on jobs threads and prints each one's output in the order
+  // given, as soon as it and every file before it have finished (--jobs N).
+  void runAll(const std::vector<std::string>& files, int jobs);
+  // Prepares file for a host program to call into, running its top level
+  // with prints going to standard output. Throws std::runtime_error if the
+  // file cannot be read, does not parse, or its top level fails.
+  std::unique_ptr<Script> load(const std::string& file) const;
 
  private:
-  void executeCode(std::string code);
+  // Scans and parses program.source, or loads the result from the cache.
+  // Returns false after a syntax error, which is reported to messages.
+  bool parse(Program& program, std::ostream& messages) const;
+  // parse(), followed by the static passes the options ask for.
+  bool prepare(Program& program, std::ostream& messages) const;
+  void executeCode(Program& program, OutputSink& out,
+                   std::ostream& messages) const;
+  void streamCode(Program& program, OutputSink& out,
+                  std::ostream& messages) const;
+  void writeProfile(const Profiler& profiler) const;
+
+  // Functions listed in the --profile summary table.
+  static const size_t kProfileTableRows = 20;
+
+  Options m_options;
 };
 }  // namespace PyInterpreter
\ No newline at end of file
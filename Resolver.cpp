@@ -0,0 +1,212 @@
+#include "Resolver.hpp"
+
+using namespace PyInterpreter;
+
+namespace {
+// Collects every name a function body binds, without descending into nested
+// function bodies, which get their own frames.
+class LocalCollector : public Expr::Visitor, public Stmt::Visitor {
+ public:
+  LocalCollector(std::unordered_map<Symbol, int>& locals)
+      : m_locals(locals) {}
+
+  void collect(const std::vector<Stmt*>& stmts) {
+    for (Stmt* stmt : stmts) stmt->accept(*this);
+  }
+
+  void visit(Assign& expr) {
+    declare(expr.name);
+    expr.value->accept(*this);
+  }
+  void visit(Literal&) {}
+  void visit(Logical& expr) {
+    expr.left->accept(*this);
+    expr.right->accept(*this);
+  }
+  void visit(Unary& expr) { expr.right->accept(*this); }
+  void visit(Variable&) {}
+  void visit(Grouping& expr) { expr.expression->accept(*this); }
+  void visit(Binary& expr) {
+    expr.left->accept(*this);
+    expr.right->accept(*this);
+  }
+  void visit(Call& expr) {
+    expr.callee->accept(*this);
+    for (Expr* arg : expr.arguments) arg->accept(*this);
+  }
+  void visit(List& expr) {
+    for (Expr* element : expr.elements) element->accept(*this);
+  }
+  void visit(Index& expr) {
+    expr.object->accept(*this);
+    expr.index->accept(*this);
+  }
+  void visit(SetIndex& expr) {
+    expr.value->accept(*this);
+    expr.object->accept(*this);
+    expr.index->accept(*this);
+  }
+  void visit(MethodCall& expr) {
+    expr.object->accept(*this);
+    for (Expr* arg : expr.arguments) arg->accept(*this);
+  }
+
+  void visit(Block& stmt) { collect(stmt.statements); }
+  void visit(IfElseBlock& stmt) { collect(stmt.statements); }
+  void visit(Expression& stmt) { stmt.expression->accept(*this); }
+  void visit(Function& stmt) { declare(stmt.name); }
+  void visit(If& stmt) {
+    stmt.condition->accept(*this);
+    stmt.thenBranch->accept(*this);
+    if (stmt.elseBranch != nullptr) stmt.elseBranch->accept(*this);
+  }
+  void visit(ReturnStmt& stmt) {
+    if (stmt.value != nullptr) stmt.value->accept(*this);
+  }
+  void visit(Print& stmt) {
+    for (Expr* expr : stmt.expressions) expr->accept(*this);
+  }
+  void visit(Var& stmt) {
+    declare(stmt.name);
+    if (stmt.initializer != nullptr) stmt.initializer->accept(*this);
+  }
+  void visit(While& stmt) {
+    stmt.condition->accept(*this);
+    collect(stmt.body);
+  }
+  void visit(For& stmt) {
+    declare(stmt.name);
+    if (stmt.start != nullptr) stmt.start->accept(*this);
+    stmt.stop->accept(*this);
+    if (stmt.step != nullptr) stmt.step->accept(*this);
+    collect(stmt.body);
+  }
+
+ private:
+  void declare(const Token& name) {
+    m_locals.emplace(name.symbol, static_cast<int>(m_locals.size()));
+  }
+
+  std::unordered_map<Symbol, int>& m_locals;
+};
+}  // namespace
+
+void Resolver::resolve(const std::vector<Stmt*>& statements) {
+  for (Stmt* stmt : statements) resolve(stmt);
+}
+
+int Resolver::lookup(Symbol name) const {
+  if (m_scope == nullptr) return -1;
+  auto found = m_scope->find(name);
+  if (found == m_scope->end()) return -1;
+  return found->second;
+}
+
+void Resolver::visit(Assign& expr) {
+  resolve(expr.value);
+  expr.slot = lookup(expr.name.symbol);
+}
+
+void Resolver::visit(Literal&) {}
+
+void Resolver::visit(Logical& expr) {
+  resolve(expr.left);
+  resolve(expr.right);
+}
+
+void Resolver::visit(Unary& expr) { resolve(expr.right); }
+
+void Resolver::visit(Variable& expr) {
+  expr.slot = lookup(expr.name.symbol);
+  if (expr.slot < 0) expr.cache = m_cacheEntries++;
+}
+
+void Resolver::visit(Grouping& expr) { resolve(expr.expression); }
+
+void Resolver::visit(Binary& expr) {
+  resolve(expr.left);
+  resolve(expr.right);
+}
+
+void Resolver::visit(Call& expr) {
+  resolve(expr.callee);
+  Variable* callee = dynamic_cast<Variable*>(expr.callee);
+  if (callee != nullptr && callee->cache >= 0) expr.global = callee;
+  for (Expr* arg : expr.arguments) resolve(arg);
+}
+
+void Resolver::visit(List& expr) {
+  for (Expr* element : expr.elements) resolve(element);
+}
+
+void Resolver::visit(Index& expr) {
+  resolve(expr.object);
+  resolve(expr.index);
+}
+
+void Resolver::visit(SetIndex& expr) {
+  resolve(expr.value);
+  resolve(expr.object);
+  resolve(expr.index);
+}
+
+void Resolver::visit(MethodCall& expr) {
+  resolve(expr.object);
+  for (Expr* arg : expr.arguments) resolve(arg);
+}
+
+void Resolver::visit(Block& stmt) { resolve(stmt.statements); }
+
+void Resolver::visit(IfElseBlock& stmt) { resolve(stmt.statements); }
+
+void Resolver::visit(Expression& stmt) { resolve(stmt.expression); }
+
+void Resolver::visit(Function& stmt) {
+  stmt.slot = lookup(stmt.name.symbol);
+
+  Scope scope;
+  for (const Token& param : stmt.parameters) {
+    scope.emplace(param.symbol, static_cast<int>(scope.size()));
+  }
+  LocalCollector(scope).collect(stmt.body);
+  stmt.numLocals = scope.size();
+
+  Scope* enclosing = m_scope;
+  m_scope = &scope;
+  resolve(stmt.body);
+  m_scope = enclosing;
+}
+
+void Resolver::visit(If& stmt) {
+  resolve(stmt.condition);
+  resolve(stmt.thenBranch);
+  if (stmt.elseBranch != nullptr) resolve(stmt.elseBranch);
+}
+
+void Resolver::visit(ReturnStmt& stmt) {
+  if (stmt.value != nullptr) resolve(stmt.value);
+  stmt.tailCall =
+      m_scope != nullptr && dynamic_cast<Call*>(stmt.value) != nullptr;
+}
+
+void Resolver::visit(Print& stmt) {
+  for (Expr* expr : stmt.expressions) resolve(expr);
+}
+
+void Resolver::visit(Var& stmt) {
+  if (stmt.initializer != nullptr) resolve(stmt.initializer);
+  stmt.slot = lookup(stmt.name.symbol);
+}
+
+void Resolver::visit(While& stmt) {
+  resolve(stmt.condition);
+  resolve(stmt.body);
+}
+
+void Resolver::visit(For& stmt) {
+  if (stmt.start != nullptr) resolve(stmt.start);
+  resolve(stmt.stop);
+  if (stmt.step != nullptr) resolve(stmt.step);
+  stmt.slot = lookup(stmt.name.symbol);
+  resolve(stmt.body);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "Expr.hpp"
+#include "Stmt.hpp"
+#include "SymbolTable.hpp"
+
+namespace PyInterpreter {
+// Static pass run between the Parser and either execution engine. Inside a
+// function, every parameter and every name the body binds (assignment or
+// nested def or for loop) gets a fixed frame slot; all other names are globals and keep
+// slot -1. Functions do not capture their enclosing frame, so a reference is
+// either to the current frame or to the global namespace. Each global read
+// also gets an index into the interpreter's global cache.
+class Resolver : public Expr::Visitor, public Stmt::Visitor {
+ public:
+  void resolve(const std::vector<Stmt*>& statements);
+  void resolve(Stmt* stmt) { stmt->accept(*this); }
+  // Global cache entries handed out so far. Once the statements resolved
+  // after a count of first have been freed, releaseCacheEntries(first) lets
+  // later global reads reuse their entries.
+  int cacheEntries() const { return m_cacheEntries; }
+  void releaseCacheEntries(int first) { m_cacheEntries = first; }
+
+  void visit(Assign& expr);
+  void visit(Literal& expr);
+  void visit(Logical& expr);
+  void visit(Unary& expr);
+  void visit(Variable& expr);
+  void visit(Grouping& expr);
+  void visit(Binary& expr);
+  void visit(Call& expr);
+  void visit(List& expr);
+  void visit(Index& expr);
+  void visit(SetIndex& expr);
+  void visit(MethodCall& expr);
+
+  void visit(Block& stmt);
+  void visit(IfElseBlock& stmt);
+  void visit(Expression& stmt);
+  void visit(Function& stmt);
+  void visit(If& stmt);
+  void visit(ReturnStmt& stmt);
+  void visit(Print& stmt);
+  void visit(Var& stmt);
+  void visit(While& stmt);
+  void visit(For& stmt);
+
+ private:
+  typedef std::unordered_map<Symbol, int> Scope;
+
+  void resolve(Expr* expr) { expr->accept(*this); }
+  int lookup(Symbol name) const;
+
+  // Locals of the function being resolved; null at the top level.
+  Scope* m_scope = nullptr;
+  // Global cache entries handed out so far, one per global read.
+  int m_cacheEntries = 0;
+};
+}  // namespace PyInterpreter
@@ -2,7 +2,8 @@
 
 using namespace PyInterpreter;
 
-Scanner::Scanner(std::string source) : m_source(source){};
+Scanner::Scanner(std::string_view source, std::ostream& messages)
+    : m_source(source), m_messages(messages) {}
 
 std::vector<Token> Scanner::scanTokens() {
   while (!isAtEnd()) {
@@ -10,7 +11,17 @@ std::vector<Token> Scanner::scanTokens() {
     scanToken();
   }
   m_tokens.emplace_back(Token::TokenType::ENDOFFILE, "", m_line);
-  return m_tokens;
+  return std::move(m_tokens);
+}
+
+Token Scanner::nextToken() {
+  m_tokens.clear();
+  while (m_tokens.empty()) {
+    if (isAtEnd()) return Token(Token::TokenType::ENDOFFILE, "", m_line);
+    m_start = m_current;
+    scanToken();
+  }
+  return m_tokens.back();
 }
 
 void Scanner::scanToken() {
@@ -28,6 +39,12 @@ void Scanner::scanToken() {
     case '}':
       addToken(Token::TokenType::RIGHT_BRACE);
       break;
+    case '[':
+      addToken(Token::TokenType::LEFT_BRACKET);
+      break;
+    case ']':
+      addToken(Token::TokenType::RIGHT_BRACKET);
+      break;
     case ',':
       addToken(Token::TokenType::COMMA);
       break;
@@ -90,18 +107,18 @@ void Scanner::scanToken() {
       } else if (isAlpha(c)) {
         identifier();
       } else {
-        std::cout << "Token not recognized on line " << m_line << std::endl;
+        m_messages << "Token not recognized on line " << m_line << std::endl;
       }
       break;
   }
 }
 
 void Scanner::addToken(Token::TokenType type) {
-  std::string text = m_source.substr(m_start, m_current - m_start);
-  m_tokens.emplace_back(type, text, m_line);
+  m_tokens.emplace_back(type, m_source.substr(m_start, m_current - m_start),
+                        m_line);
 }
 
-void Scanner::addToken(Token::TokenType type, std::string literal) {
+void Scanner::addToken(Token::TokenType type, std::string_view literal) {
   m_tokens.emplace_back(type, literal, m_line);
 }
 
@@ -114,14 +131,15 @@ void Scanner::indentation() {
 void Scanner::identifier() {
   while (isAlphaNumeric(peek())) advance();
 
-  std::string text = m_source.substr(m_start, m_current - m_start);
-  Token::TokenType type;
-  try {
-    type = m_keywords.at(text);
-  } catch (std::out_of_range err) {
-    type = Token::TokenType::IDENTIFIER;
+  std::string_view text = m_source.substr(m_start, m_current - m_start);
+  Symbol symbol = SymbolTable::instance().intern(text);
+  const std::vector<Token::TokenType>& keywords = keywordTypes();
+  if (symbol < keywords.size() &&
+      keywords[symbol] != Token::TokenType::IDENTIFIER) {
+    addToken(keywords[symbol]);
+  } else {
+    m_tokens.emplace_back(Token::TokenType::IDENTIFIER, text, m_line, symbol);
   }
-  addToken(type);
 }
 
 void Scanner::string() {
@@ -131,7 +149,7 @@ void Scanner::string() {
   }
 
   if (isAtEnd()) {
-    std::cout << "Undetermined string" << std::endl;
+    m_messages << "Undetermined string" << std::endl;
     return;
   }
 
@@ -139,8 +157,8 @@ void Scanner::string() {
   advance();
 
   // Trim quotes
-  std::string val = m_source.substr(m_start + 1, m_current - m_start - 2);
-  addToken(Token::TokenType::STRING, val);
+  addToken(Token::TokenType::STRING,
+           m_source.substr(m_start + 1, m_current - m_start - 2));
 }
 
 void Scanner::number() {
@@ -160,3 +178,34 @@ bool Scanner::match(char expected) {
   m_current++;
   return true;
 }
+
+const std::vector<Token::TokenType>& Scanner::keywordTypes() {
+  static const std::vector<Token::TokenType> types = [] {
+    const std::pair<const char*, Token::TokenType> keywords[] = {
+        {"and", Token::TokenType::AND},
+        {"def", Token::TokenType::DEF},
+        {"else", Token::TokenType::ELSE},
+        {"false", Token::TokenType::FALSE},
+        {"for", Token::TokenType::FOR},
+        {"global", Token::TokenType::GLOBAL},
+        {"if", Token::TokenType::IF},
+        {"in", Token::TokenType::IN},
+        {"none", Token::TokenType::NONE},
+        {"not", Token::TokenType::NOT},
+        {"or", Token::TokenType::OR},
+        {"return", Token::TokenType::RETURN},
+        {"true", Token::TokenType::TRUE},
+        {"print", Token::TokenType::PRINT},
+        {"while", Token::TokenType::WHILE}};
+    std::vector<Token::TokenType> types;
+    for (const auto& keyword : keywords) {
+      Symbol symbol = SymbolTable::instance().intern(keyword.first);
+      if (types.size() <= symbol) {
+        types.resize(symbol + 1, Token::TokenType::IDENTIFIER);
+      }
+      types[symbol] = keyword.second;
+    }
+    return types;
+  }();
+  return types;
+}
@@ -2,21 +2,26 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
 
+#include "SymbolTable.hpp"
 #include "Token.hpp"
 
 namespace PyInterpreter {
 class Scanner {
  public:
-  Scanner(std::string source);
+  // Complaints about unrecognized characters go to messages.
+  Scanner(std::string_view source, std::ostream& messages = std::cout);
   std::vector<Token> scanTokens();
+  // Scans just far enough to return the next token; ENDOFFILE once the
+  // source is exhausted, and on every call after that.
+  Token nextToken();
 
  private:
   void scanToken();
   void addToken(Token::TokenType type);
-  void addToken(Token::TokenType type, std::string literal);
+  void addToken(Token::TokenType type, std::string_view literal);
   void identifier();
   void indentation();
   void string();
@@ -36,23 +41,13 @@ class Scanner {
   constexpr bool isAlphaNumeric(char c) { return isAlpha(c) || isDigit(c); }
 
   std::vector<Token> m_tokens;
-  const std::string m_source;
-  int m_start = 0;
-  int m_current = 0;
+  const std::string_view m_source;
+  std::ostream& m_messages;
+  size_t m_start = 0;
+  size_t m_current = 0;
   int m_line = 1;
 
-  const std::unordered_map<std::string, Token::TokenType> m_keywords{
-      {"and", Token::TokenType::AND},
-      {"def", Token::TokenType::DEF},
-      {"else", Token::TokenType::ELSE},
-      {"false", Token::TokenType::FALSE},
-      {"global", Token::TokenType::GLOBAL},
-      {"if", Token::TokenType::IF},
-      {"none", Token::TokenType::NONE},
-      {"not", Token::TokenType::NOT},
-      {"or", Token::TokenType::OR},
-      {"return", Token::TokenType::RETURN},
-      {"true", Token::TokenType::TRUE},
-      {"print", Token::TokenType::PRINT}};
+  // Keyword token type indexed by symbol; IDENTIFIER for any other name.
+  static const std::vector<Token::TokenType>& keywordTypes();
 };
 }  // namespace PyInterpreter
\ No newline at end of file
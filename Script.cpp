@@ -0,0 +1,31 @@
+#include "Script.hpp"
+
+#include <stdexcept>
+#include <string>
+
+using namespace PyInterpreter;
+
+PyCallable* Script::function(std::string_view name) const {
+  Value value;
+  if (!m_interpreter.global(name, value) || !value.isFunction()) {
+    return nullptr;
+  }
+  return value.asFunction();
+}
+
+Value Script::call(PyCallable* function, const std::vector<Value>& args) {
+  Value result;
+  std::string error;
+  if (!m_interpreter.call(function, args, result, error)) {
+    throw std::runtime_error(error);
+  }
+  return result;
+}
+
+Value Script::call(std::string_view name, const std::vector<Value>& args) {
+  PyCallable* callee = function(name);
+  if (callee == nullptr) {
+    throw std::runtime_error("No function named " + std::string(name) + ".");
+  }
+  return call(callee, args);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "Interpreter.hpp"
+#include "Jit.hpp"
+#include "OutputSink.hpp"
+#include "Program.hpp"
+#include "PyCallable.hpp"
+#include "Value.hpp"
+
+namespace PyInterpreter {
+// A script loaded once for a host program to call into (Python::load).
+// Loading scans, parses and resolves the file and runs its top level, which
+// binds its functions and globals; calls then reuse that state, so a call
+// costs only the function body. Memoized results also persist between
+// calls. Scripts always run on the tree interpreter and must be used from
+// the thread that loaded them.
+class Script {
+ public:
+  Script(const Script&) = delete;
+  Script& operator=(const Script&) = delete;
+
+  // The function the top level bound to name, or null if there is none.
+  // Valid for the life of the Script; looking a function up once and
+  // calling it through the pointer saves a name lookup per call.
+  PyCallable* function(std::string_view name) const;
+  // Throws std::runtime_error carrying the script's error message if the
+  // call fails, or if no function is bound to name.
+  Value call(PyCallable* function, const std::vector<Value>& args);
+  Value call(std::string_view name, const std::vector<Value>& args);
+  // Flushes anything the script has printed.
+  void flush() { m_out.flush(); }
+
+ private:
+  friend class Python;
+
+  Script(int fd, OutputSink::FlushPolicy policy, int maxDepth)
+      : m_out(fd, policy), m_interpreter(m_out, maxDepth) {}
+
+  OutputSink m_out;
+  // Declared before the interpreter, whose functions point into them.
+  Program m_program;
+  Jit m_jit;
+  Interpreter m_interpreter;
+};
+}  // namespace PyInterpreter
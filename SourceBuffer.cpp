@@ -0,0 +1,50 @@
+#include "SourceBuffer.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace PyInterpreter;
+
+std::unique_ptr<SourceBuffer> SourceBuffer::open(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return nullptr;
+
+  std::unique_ptr<SourceBuffer> buffer(new SourceBuffer());
+  struct stat info;
+  if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+    void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      // The scanner reads front to back exactly once.
+      madvise(data, info.st_size, MADV_SEQUENTIAL);
+      buffer->m_data = static_cast<const char*>(data);
+      buffer->m_size = info.st_size;
+      buffer->m_mapped = true;
+      ::close(fd);
+      return buffer;
+    }
+  }
+
+  char chunk[1 << 16];
+  ssize_t count;
+  while ((count = ::read(fd, chunk, sizeof(chunk))) > 0) {
+    buffer->m_contents.append(chunk, count);
+  }
+  ::close(fd);
+  buffer->m_data = buffer->m_contents.data();
+  buffer->m_size = buffer->m_contents.size();
+  return buffer;
+}
+
+std::unique_ptr<SourceBuffer> SourceBuffer::fromString(std::string text) {
+  std::unique_ptr<SourceBuffer> buffer(new SourceBuffer());
+  buffer->m_contents = std::move(text);
+  buffer->m_data = buffer->m_contents.data();
+  buffer->m_size = buffer->m_contents.size();
+  return buffer;
+}
+
+SourceBuffer::~SourceBuffer() {
+  if (m_mapped) munmap(const_cast<char*>(m_data), m_size);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace PyInterpreter {
+// Read-only view of a script's bytes. Regular files are mapped with mmap so
+// the scanner and every token lexeme point straight into the page cache;
+// anything that cannot be mapped (pipes, special files) is read into memory.
+class SourceBuffer {
+ public:
+  // Returns null if the file cannot be opened.
+  static std::unique_ptr<SourceBuffer> open(const std::string& path);
+  // Wraps source text that was built in memory.
+  static std::unique_ptr<SourceBuffer> fromString(std::string text);
+
+  SourceBuffer(const SourceBuffer&) = delete;
+  SourceBuffer& operator=(const SourceBuffer&) = delete;
+  ~SourceBuffer();
+
+  std::string_view text() const { return std::string_view(m_data, m_size); }
+
+ private:
+  SourceBuffer() {}
+
+  const char* m_data = nullptr;
+  size_t m_size = 0;
+  bool m_mapped = false;
+  std::string m_contents;
+};
+}  // namespace PyInterpreter
@@ -18,6 +18,8 @@ class Function;
 class If;
 class Print;
 class Var;
+class While;
+class For;
 
 class Stmt {
  public:
@@ -31,8 +33,11 @@ class Stmt {
     virtual void visit(If& stmt) = 0;
     virtual void visit(Print& stmt) = 0;
     virtual void visit(Var& stmt) = 0;
+    virtual void visit(While& stmt) = 0;
+    virtual void visit(For& stmt) = 0;
   };
 
+  virtual ~Stmt() = default;
   virtual void accept(Visitor& visitor) = 0;
 };
 
@@ -67,6 +72,9 @@ class ReturnStmt : public Stmt {
 
   Token keyword;
   Expr* value;
+  // Set by the Resolver when value is a call made from inside a function,
+  // so the callee can run in place of the returning frame.
+  bool tailCall = false;
 };
 
 class Function : public Stmt {
@@ -78,6 +86,12 @@ class Function : public Stmt {
   Token name;
   std::vector<Token> parameters;
   std::vector<Stmt*> body;
+  // Filled in by the Resolver: the slot the name binds to in the enclosing
+  // frame (-1 for globals) and the frame size, parameters first.
+  int slot = -1;
+  int numLocals = 0;
+  // Set by PurityAnalysis when calls may be answered from a memo cache.
+  bool pure = false;
 };
 
 class If : public Stmt {
@@ -106,5 +120,36 @@ class Var : public Stmt {
 
   Token name;
   Expr* initializer;
+  // Frame slot assigned by the Resolver; -1 for globals.
+  int slot = -1;
+};
+
+class While : public Stmt {
+ public:
+  While(Expr* cond, std::vector<Stmt*> b) : condition(cond), body(b) {}
+  MAKE_VISITABLE_STMT
+
+  Expr* condition;
+  std::vector<Stmt*> body;
+};
+
+// for name in range(start, stop, step): start and step are null when the
+// source leaves them out, meaning 0 and 1.
+class For : public Stmt {
+ public:
+  For(Token n, Token r, Expr* first, Expr* last, Expr* by,
+      std::vector<Stmt*> b)
+      : name(n), range(r), start(first), stop(last), step(by), body(b) {}
+  MAKE_VISITABLE_STMT
+
+  Token name;
+  // The word range, where bad arguments are reported.
+  Token range;
+  Expr* start;
+  Expr* stop;
+  Expr* step;
+  std::vector<Stmt*> body;
+  // Frame slot of name assigned by the Resolver; -1 for globals.
+  int slot = -1;
 };
 }  // namespace PyInterpreter
\ No newline at end of file
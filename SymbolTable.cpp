@@ -0,0 +1,69 @@
+#include "SymbolTable.hpp"
+
+#include <cstring>
+
+using namespace PyInterpreter;
+
+SymbolTable& SymbolTable::instance() {
+  static SymbolTable table;
+  return table;
+}
+
+SymbolTable::SymbolTable() : m_buckets(256, 0) {
+  m_symbols.push_back({std::string_view(), 0});
+}
+
+uint64_t SymbolTable::hashName(std::string_view name) {
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : name) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+Symbol SymbolTable::intern(std::string_view name) {
+  const uint64_t hash = hashName(name);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const size_t mask = m_buckets.size() - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    Symbol symbol = m_buckets[i];
+    if (symbol == 0) break;
+    if (m_symbols[symbol].hash == hash && m_symbols[symbol].name == name) {
+      return symbol;
+    }
+  }
+
+  char* storage = static_cast<char*>(m_names.allocate(name.size() + 1, 1));
+  std::memcpy(storage, name.data(), name.size());
+  storage[name.size()] = '\0';
+  Symbol symbol = m_symbols.size();
+  m_symbols.push_back({std::string_view(storage, name.size()), hash});
+
+  if (m_symbols.size() * 2 > m_buckets.size()) {
+    grow();
+  } else {
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+      if (m_buckets[i] == 0) {
+        m_buckets[i] = symbol;
+        break;
+      }
+    }
+  }
+  return symbol;
+}
+
+void SymbolTable::grow() {
+  std::vector<Symbol> buckets(m_buckets.size() * 2, 0);
+  const size_t mask = buckets.size() - 1;
+  for (Symbol symbol = 1; symbol < m_symbols.size(); symbol++) {
+    for (size_t i = m_symbols[symbol].hash & mask;; i = (i + 1) & mask) {
+      if (buckets[i] == 0) {
+        buckets[i] = symbol;
+        break;
+      }
+    }
+  }
+  m_buckets.swap(buckets);
+}
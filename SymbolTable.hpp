@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "Arena.hpp"
+
+namespace PyInterpreter {
+typedef uint32_t Symbol;
+
+// Process-wide identifier interning. The scanner interns every identifier
+// once, so later stages compare and hash names as small integers. Symbol 0
+// is never handed out and marks "no symbol". Scripts scanned on different
+// threads share the table, so every access takes m_mutex.
+class SymbolTable {
+ public:
+  static SymbolTable& instance();
+
+  Symbol intern(std::string_view name);
+  // The returned view stays valid for the life of the process.
+  std::string_view name(Symbol symbol) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_symbols[symbol].name;
+  }
+  // Hash of the name, computed once at interning time.
+  uint64_t hash(Symbol symbol) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_symbols[symbol].hash;
+  }
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_symbols.size();
+  }
+
+ private:
+  SymbolTable();
+
+  struct Entry {
+    std::string_view name;
+    uint64_t hash;
+  };
+
+  static uint64_t hashName(std::string_view name);
+  void grow();
+
+  std::vector<Entry> m_symbols;
+  // Open-addressing index over m_symbols; 0 marks an empty bucket.
+  std::vector<Symbol> m_buckets;
+  // Owns the characters of every interned name.
+  Arena m_names;
+  mutable std::mutex m_mutex;
+};
+}  // namespace PyInterpreter
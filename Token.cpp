@@ -2,5 +2,6 @@
 
 using namespace PyInterpreter;
 
-Token::Token(const TokenType& type, const std::string& lexeme, const int& line)
-    : type(type), lexeme(lexeme), line(line) {}
\ No newline at end of file
+Token::Token(const TokenType& type, std::string_view lexeme, const int& line,
+             Symbol symbol)
+    : type(type), lexeme(lexeme), line(line), symbol(symbol) {}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
-#include <string>
+#include <string_view>
+
+#include "SymbolTable.hpp"
 
 namespace PyInterpreter {
 
@@ -12,6 +14,8 @@ class Token {
     RIGHT_PAREN,
     LEFT_BRACE,
     RIGHT_BRACE,
+    LEFT_BRACKET,
+    RIGHT_BRACKET,
     COMMA,
     DOT,
     MINUS,
@@ -42,8 +46,10 @@ class Token {
     DEF,
     ELSE,
     FALSE,
+    FOR,
     GLOBAL,
     IF,
+    IN,
     NONE,
     NOT,
     OR,
@@ -51,14 +57,18 @@ class Token {
     TRUE,
     NUL,
     PRINT,
+    WHILE,
 
     ENDOFFILE
   };
-  Token(const TokenType& type, const std::string& lexeme,
-        const int& line);
+  Token(const TokenType& type, std::string_view lexeme, const int& line,
+        Symbol symbol = 0);
 
   const TokenType type;
-  const std::string lexeme;
+  // Points into the SourceBuffer the token was scanned from.
+  const std::string_view lexeme;
   const int line;
+  // Interned name of an IDENTIFIER; 0 for every other token type.
+  const Symbol symbol;
 };
 }  // namespace PyInterpreter
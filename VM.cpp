@@ -0,0 +1,468 @@
+#include "VM.hpp"
+
+#include <stdexcept>
+
+#include "Builtins.hpp"
+#include "Operators.hpp"
+
+#if defined(__GNUC__)
+#define PY_COMPUTED_GOTO 1
+#else
+#define PY_COMPUTED_GOTO 0
+#endif
+
+using namespace PyInterpreter;
+
+namespace {
+const int kInitialStack = 1 << 12;
+}
+
+void VM::interpret(const CompiledProgram& program) {
+  m_program = &program;
+  m_globals.assign(program.globalNames.size(), Global());
+  for (size_t i = 0; i < m_globals.size(); i++) {
+    if (const Builtin* builtin = Builtins::find(program.globalNames[i])) {
+      m_globals[i].value = Value::builtin(builtin);
+      m_globals[i].defined = true;
+    }
+  }
+  m_stack.assign(kInitialStack, Value());
+  m_frames.clear();
+
+  BytecodeFunction* script = program.script;
+  m_stackTop = m_stack.data();
+  ensureStack(m_stackTop, script->maxStack + 1);
+  *m_stackTop++ = Value::function(script);
+  m_frames.push_back({script, script->chunk.code.data(), m_stackTop});
+
+  try {
+    run();
+  } catch (const std::runtime_error& e) {
+    m_out.write(e.what());
+    m_out.endLine();
+  }
+  m_frames.clear();
+  m_stack.clear();
+  m_globals.clear();
+}
+
+void VM::ensureStack(Value* top, int needed) {
+  size_t used = top - m_stack.data();
+  if (used + needed <= m_stack.size()) return;
+
+  Value* oldBase = m_stack.data();
+  size_t size = m_stack.size();
+  while (used + needed > size) size *= 2;
+  std::vector<Value> grown(size);
+  for (size_t i = 0; i < used; i++) grown[i] = std::move(m_stack[i]);
+  m_stack.swap(grown);
+
+  Value* newBase = m_stack.data();
+  for (CallFrame& frame : m_frames) {
+    frame.slots = newBase + (frame.slots - oldBase);
+  }
+  m_stackTop = newBase + used;
+}
+
+BytecodeFunction* VM::checkCall(const CallFrame& frame, const uint8_t* ip,
+                                const Value& callee, int argc) {
+  if (!callee.isFunction()) {
+    runtimeError(frame, ip, "Can only call functions.");
+  }
+  BytecodeFunction* function =
+      static_cast<BytecodeFunction*>(callee.asFunction());
+  if (argc != function->numParams) {
+    runtimeError(frame, ip,
+                 "Expected " + std::to_string(function->numParams) +
+                     " arguments but got " + std::to_string(argc) + ".");
+  }
+  return function;
+}
+
+void VM::callBuiltin(const CallFrame& frame, const uint8_t* ip, Value* top,
+                     int argc) {
+  const Builtin& builtin = *top[-argc - 1].asBuiltin();
+  if (argc != builtin.arity) {
+    runtimeError(frame, ip,
+                 "Expected " + std::to_string(builtin.arity) +
+                     " arguments but got " + std::to_string(argc) + ".");
+  }
+  Value result;
+  const char* error;
+  if (!builtin.function(top - argc, result, error)) {
+    runtimeError(frame, ip, error);
+  }
+  top[-argc - 1] = std::move(result);
+  for (int i = 1; i <= argc; i++) top[-i] = Value();
+}
+
+void VM::runtimeError(const CallFrame& frame, const uint8_t* ip,
+                      const std::string& message) {
+  const Chunk& chunk = frame.function->chunk;
+  int line = chunk.lines[ip - chunk.code.data() - 1];
+  throw std::runtime_error("Line " + std::to_string(line) + ": " + message);
+}
+
+void VM::binaryOp(const CallFrame& frame, const uint8_t* ip,
+                  Token::TokenType op, Value& left, const Value& right) {
+  Value result;
+  const char* error;
+  if (!Operators::binary(op, left, right, result, error)) {
+    runtimeError(frame, ip, error);
+  }
+  left = std::move(result);
+}
+
+void VM::run() {
+  CallFrame* frame = &m_frames.back();
+  const uint8_t* ip = frame->ip;
+  Value* slots = frame->slots;
+  Value* top = m_stackTop;
+
+#define READ_BYTE() (*ip++)
+#define READ_SHORT() (ip += 2, static_cast<uint16_t>((ip[-2] << 8) | ip[-1]))
+// Arithmetic leaves the fast path when the int64_t result would overflow.
+#define ARITHMETIC_OP(tokenType, overflow)                            \
+  do {                                                                \
+    Value right = std::move(*--top);                                  \
+    Value& left = top[-1];                                            \
+    int64_t result;                                                   \
+    if (left.isInt() && right.isInt() &&                              \
+        !overflow(left.asInt(), right.asInt(), &result)) {            \
+      left = Value::integer(result);                                  \
+    } else {                                                          \
+      binaryOp(*frame, ip, Token::TokenType::tokenType, left, right);  \
+    }                                                                 \
+  } while (0)
+
+#define BINARY_OP(tokenType, intResult)                               \
+  do {                                                                \
+    Value right = std::move(*--top);                                  \
+    Value& left = top[-1];                                            \
+    if (left.isInt() && right.isInt()) {                              \
+      int64_t a = left.asInt(), b = right.asInt();                    \
+      left = intResult;                                               \
+    } else {                                                          \
+      binaryOp(*frame, ip, Token::TokenType::tokenType, left, right);  \
+    }                                                                 \
+  } while (0)
+
+#if PY_COMPUTED_GOTO
+  static const void* dispatchTable[] = {
+#define PY_OPCODE_LABEL(name) &&op_##name,
+      PY_OPCODES(PY_OPCODE_LABEL)
+#undef PY_OPCODE_LABEL
+  };
+// A computed goto leaves a case without running destructors, so no Value
+// holding an object may still be in scope at DISPATCH().
+#define DISPATCH() goto* dispatchTable[*ip++]
+#define CASE(name) op_##name:
+  DISPATCH();
+#else
+#define DISPATCH() break
+#define CASE(name) case OpCode::name:
+  for (;;) {
+    switch (static_cast<OpCode>(*ip++)) {
+#endif
+
+  CASE(CONSTANT) {
+    *top++ = frame->function->chunk.constants[READ_SHORT()];
+    DISPATCH();
+  }
+  CASE(NONE) {
+    *top++ = Value::none();
+    DISPATCH();
+  }
+  CASE(TRUE) {
+    *top++ = Value::boolean(true);
+    DISPATCH();
+  }
+  CASE(FALSE) {
+    *top++ = Value::boolean(false);
+    DISPATCH();
+  }
+  CASE(POP) {
+    *--top = Value();
+    DISPATCH();
+  }
+  CASE(GET_LOCAL) {
+    *top++ = slots[READ_BYTE()];
+    DISPATCH();
+  }
+  CASE(SET_LOCAL) {
+    slots[READ_BYTE()] = top[-1];
+    DISPATCH();
+  }
+  CASE(GET_GLOBAL) {
+    uint16_t index = READ_SHORT();
+    Global& global = m_globals[index];
+    if (!global.defined) {
+      runtimeError(*frame, ip, "Undefined variable " +
+                                   m_program->globalNames[index] + ".");
+    }
+    *top++ = global.value;
+    DISPATCH();
+  }
+  CASE(SET_GLOBAL) {
+    Global& global = m_globals[READ_SHORT()];
+    global.value = top[-1];
+    global.defined = true;
+    DISPATCH();
+  }
+  CASE(EQUAL) {
+    {
+      Value right = std::move(*--top);
+      top[-1] = Value::boolean(top[-1] == right);
+    }
+    DISPATCH();
+  }
+  CASE(NOT_EQUAL) {
+    {
+      Value right = std::move(*--top);
+      top[-1] = Value::boolean(top[-1] != right);
+    }
+    DISPATCH();
+  }
+  CASE(GREATER) {
+    BINARY_OP(GREATER, Value::boolean(a > b));
+    DISPATCH();
+  }
+  CASE(GREATER_EQUAL) {
+    BINARY_OP(GREATER_EQUAL, Value::boolean(a >= b));
+    DISPATCH();
+  }
+  CASE(LESS) {
+    BINARY_OP(LESS, Value::boolean(a < b));
+    DISPATCH();
+  }
+  CASE(LESS_EQUAL) {
+    BINARY_OP(LESS_EQUAL, Value::boolean(a <= b));
+    DISPATCH();
+  }
+  CASE(ADD) {
+    ARITHMETIC_OP(PLUS, __builtin_add_overflow);
+    DISPATCH();
+  }
+  CASE(SUBTRACT) {
+    ARITHMETIC_OP(MINUS, __builtin_sub_overflow);
+    DISPATCH();
+  }
+  CASE(MULTIPLY) {
+    ARITHMETIC_OP(STAR, __builtin_mul_overflow);
+    DISPATCH();
+  }
+  CASE(DIVIDE) {
+    // Division by zero is reported by the shared operator implementation.
+    {
+      Value right = std::move(*--top);
+      binaryOp(*frame, ip, Token::TokenType::SLASH, top[-1], right);
+    }
+    DISPATCH();
+  }
+  CASE(NOT) {
+    top[-1] = Value::boolean(!top[-1].truthy());
+    DISPATCH();
+  }
+  CASE(NEGATE) {
+    if (top[-1].isInt() && top[-1].asInt() != INT64_MIN) {
+      top[-1] = Value::integer(-top[-1].asInt());
+    } else {
+      Value result;
+      const char* error;
+      if (!Operators::unary(Token::TokenType::MINUS, top[-1], result, error)) {
+        runtimeError(*frame, ip, error);
+      }
+      top[-1] = std::move(result);
+    }
+    DISPATCH();
+  }
+  CASE(JUMP) {
+    uint16_t offset = READ_SHORT();
+    ip += offset;
+    DISPATCH();
+  }
+  CASE(JUMP_IF_FALSE) {
+    uint16_t offset = READ_SHORT();
+    if (!top[-1].truthy()) ip += offset;
+    DISPATCH();
+  }
+  CASE(JUMP_IF_TRUE) {
+    uint16_t offset = READ_SHORT();
+    if (top[-1].truthy()) ip += offset;
+    DISPATCH();
+  }
+  CASE(POP_JUMP_IF_FALSE) {
+    uint16_t offset = READ_SHORT();
+    if (!top[-1].truthy()) ip += offset;
+    *--top = Value();
+    DISPATCH();
+  }
+  CASE(LOOP) {
+    uint16_t offset = READ_SHORT();
+    ip -= offset;
+    DISPATCH();
+  }
+  CASE(RANGE) {
+    if (!top[-3].isInt() || !top[-2].isInt() || !top[-1].isInt()) {
+      runtimeError(*frame, ip, "range() arguments must be 64-bit integers.");
+    }
+    if (top[-1].asInt() == 0) {
+      runtimeError(*frame, ip, "range() step must not be zero.");
+    }
+    DISPATCH();
+  }
+  CASE(FOR_RANGE) {
+    // Pushes the counter and advances it, or drops the range once the
+    // counter reaches stop.
+    uint16_t offset = READ_SHORT();
+    const int64_t counter = top[-3].asInt();
+    const int64_t stop = top[-2].asInt();
+    const int64_t step = top[-1].asInt();
+    if (step > 0 ? counter < stop : counter > stop) {
+      int64_t next;
+      // Stepping past the int64_t range also steps past stop.
+      if (__builtin_add_overflow(counter, step, &next)) next = stop;
+      top[-3] = Value::integer(next);
+      *top++ = Value::integer(counter);
+    } else {
+      top -= 3;
+      ip += offset;
+    }
+    DISPATCH();
+  }
+  CASE(CALL) {
+    int argc = READ_BYTE();
+    if (top[-argc - 1].isBuiltin()) {
+      callBuiltin(*frame, ip, top, argc);
+      top -= argc;
+      DISPATCH();
+    }
+    BytecodeFunction* function = checkCall(*frame, ip, top[-argc - 1], argc);
+    // The script's own frame does not count towards the depth.
+    if (m_frames.size() > static_cast<size_t>(m_maxDepth)) {
+      runtimeError(*frame, ip, "Maximum recursion depth exceeded.");
+    }
+
+    frame->ip = ip;
+    size_t topOffset = top - m_stack.data();
+    ensureStack(top, function->maxStack);
+    top = m_stack.data() + topOffset;
+    Value* newSlots = top - argc;
+    for (int i = argc; i < function->numLocals; i++) *top++ = Value();
+
+    m_frames.push_back({function, function->chunk.code.data(), newSlots});
+    frame = &m_frames.back();
+    ip = frame->ip;
+    slots = newSlots;
+    DISPATCH();
+  }
+  CASE(TAIL_CALL) {
+    int argc = READ_BYTE();
+    Value* callee = top - argc - 1;
+    // A builtin leaves its result where a RETURN expects it.
+    if (callee->isBuiltin()) {
+      callBuiltin(*frame, ip, top, argc);
+      top -= argc;
+      goto returnFromFrame;
+    }
+    BytecodeFunction* function = checkCall(*frame, ip, *callee, argc);
+
+    // Slide the callee and its arguments down over the returning frame.
+    Value* base = slots - 1;
+    for (int i = 0; i <= argc; i++) base[i] = std::move(callee[i]);
+    Value* end = base + argc + 1;
+    while (top > end) *--top = Value();
+
+    size_t topOffset = top - m_stack.data();
+    ensureStack(top, function->maxStack);
+    top = m_stack.data() + topOffset;
+    slots = top - argc;
+    for (int i = argc; i < function->numLocals; i++) *top++ = Value();
+
+    frame->function = function;
+    frame->slots = slots;
+    ip = function->chunk.code.data();
+    DISPATCH();
+  }
+  CASE(RETURN) {
+  returnFromFrame:
+    Value result = std::move(*--top);
+    Value* base = slots - 1;
+    while (top > base) *--top = Value();
+    m_frames.pop_back();
+    if (m_frames.empty()) {
+      m_stackTop = top;
+      return;
+    }
+    *top++ = std::move(result);
+    frame = &m_frames.back();
+    ip = frame->ip;
+    slots = frame->slots;
+    DISPATCH();
+  }
+  CASE(BUILD_LIST) {
+    const uint16_t count = READ_SHORT();
+    ListObj* list = new ListObj();
+    Value value = Value::list(list);
+    list->reserve(count);
+    for (Value* element = top - count; element < top; element++) {
+      list->append(*element);
+      *element = Value();
+    }
+    top -= count;
+    *top++ = std::move(value);
+    DISPATCH();
+  }
+  CASE(INDEX) {
+    {
+      Value result;
+      const char* error;
+      if (!Operators::index(top[-2], top[-1], result, error)) {
+        runtimeError(*frame, ip, error);
+      }
+      *--top = Value();
+      top[-1] = std::move(result);
+    }
+    DISPATCH();
+  }
+  CASE(SET_INDEX) {
+    const char* error;
+    if (!Operators::setIndex(top[-2], top[-1], top[-3], error)) {
+      runtimeError(*frame, ip, error);
+    }
+    *--top = Value();
+    *--top = Value();
+    DISPATCH();
+  }
+  CASE(APPEND) {
+    const char* error;
+    if (!Operators::append(top[-2], top[-1], error)) {
+      runtimeError(*frame, ip, error);
+    }
+    *--top = Value();
+    top[-1] = Value();
+    DISPATCH();
+  }
+  CASE(PRINT) {
+    m_out.write(top[-1]);
+    m_out.write(' ');
+    *--top = Value();
+    DISPATCH();
+  }
+  CASE(PRINT_LINE) {
+    m_out.endLine();
+    DISPATCH();
+  }
+
+#if !PY_COMPUTED_GOTO
+    }
+  }
+#endif
+
+#undef READ_BYTE
+#undef READ_SHORT
+#undef ARITHMETIC_OP
+#undef BINARY_OP
+#undef DISPATCH
+#undef CASE
+}
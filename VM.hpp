@@ -0,0 +1,60 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Chunk.hpp"
+#include "Compiler.hpp"
+#include "Interpreter.hpp"
+#include "OutputSink.hpp"
+#include "Value.hpp"
+
+namespace PyInterpreter {
+// Stack-based bytecode VM. Script-level calls push a CallFrame instead of
+// recursing on the native stack; locals live in the value stack at the
+// frame's base.
+class VM {
+ public:
+  VM(OutputSink& out, int maxDepth = kDefaultMaxDepth)
+      : m_out(out), m_maxDepth(maxDepth) {}
+
+  void interpret(const CompiledProgram& program);
+
+ private:
+  struct CallFrame {
+    BytecodeFunction* function;
+    const uint8_t* ip;
+    Value* slots;
+  };
+
+  struct Global {
+    Value value;
+    bool defined = false;
+  };
+
+  void run();
+  void ensureStack(Value* top, int needed);
+  // Checks that callee can take argc arguments and returns it.
+  BytecodeFunction* checkCall(const CallFrame& frame, const uint8_t* ip,
+                              const Value& callee, int argc);
+  // Runs the builtin below the argc arguments ending at top, replacing it
+  // with the result and clearing the arguments.
+  void callBuiltin(const CallFrame& frame, const uint8_t* ip, Value* top,
+                   int argc);
+  void runtimeError(const CallFrame& frame, const uint8_t* ip,
+                    const std::string& message);
+  // Slow path for operands the inline int fast paths do not cover; the
+  // result replaces left.
+  void binaryOp(const CallFrame& frame, const uint8_t* ip, Token::TokenType op,
+                Value& left, const Value& right);
+
+  std::vector<Value> m_stack;
+  Value* m_stackTop = nullptr;
+  std::vector<CallFrame> m_frames;
+  std::vector<Global> m_globals;
+  const CompiledProgram* m_program = nullptr;
+  OutputSink& m_out;
+  const int m_maxDepth;
+};
+}  // namespace PyInterpreter
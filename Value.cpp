@@ -0,0 +1,118 @@
+#include "Value.hpp"
+
+#include <algorithm>
+
+#include "Builtins.hpp"
+#include "PyCallable.hpp"
+
+using namespace PyInterpreter;
+
+namespace {
+// Lists being converted by str() on this thread, so one that contains
+// itself prints as [...] instead of recursing forever.
+thread_local std::vector<const ListObj*> t_printing;
+}  // namespace
+
+bool Value::truthy() const {
+  switch (m_type) {
+    case Type::NONE:
+      return false;
+    case Type::BOOL:
+      return m_as.boolean;
+    case Type::INT:
+      return m_as.integer != 0;
+    case Type::BIGINT:
+      return true;
+    case Type::STRING:
+      return !asString().empty();
+    case Type::FUNCTION:
+      return true;
+    case Type::LIST:
+      return asList()->size() != 0;
+    case Type::BUILTIN:
+      return true;
+  }
+  return false;
+}
+
+std::string Value::str() const {
+  switch (m_type) {
+    case Type::NONE:
+      return "none";
+    case Type::BOOL:
+      return m_as.boolean ? "true" : "false";
+    case Type::INT:
+      return std::to_string(m_as.integer);
+    case Type::BIGINT:
+      return asBigInt().toString();
+    case Type::STRING:
+      return asString();
+    case Type::FUNCTION:
+      return m_as.function->toString();
+    case Type::LIST:
+      return asList()->str();
+    case Type::BUILTIN:
+      return "<builtin " + std::string(m_as.builtin->name) + ">";
+  }
+  return "";
+}
+
+bool Value::operator==(const Value& other) const {
+  if (m_type != other.m_type) return false;
+  switch (m_type) {
+    case Type::NONE:
+      return true;
+    case Type::BOOL:
+      return m_as.boolean == other.m_as.boolean;
+    case Type::INT:
+      return m_as.integer == other.m_as.integer;
+    case Type::BIGINT:
+      return asBigInt().compare(other.asBigInt()) == 0;
+    case Type::STRING:
+      return m_as.object == other.m_as.object ||
+             asString() == other.asString();
+    case Type::FUNCTION:
+      return m_as.function == other.m_as.function;
+    case Type::LIST:
+      return m_as.object == other.m_as.object ||
+             asList()->equals(*other.asList());
+    case Type::BUILTIN:
+      return m_as.builtin == other.m_as.builtin;
+  }
+  return false;
+}
+
+std::string ListObj::str() const {
+  if (std::find(t_printing.begin(), t_printing.end(), this) !=
+      t_printing.end()) {
+    return "[...]";
+  }
+  t_printing.push_back(this);
+  std::string text = "[";
+  for (size_t i = 0; i < size(); i++) {
+    if (i > 0) text += ", ";
+    const Value element = get(i);
+    // Strings are quoted inside a list, as Python does.
+    text += element.isString() ? "'" + element.asString() + "'"
+                               : element.str();
+  }
+  t_printing.pop_back();
+  return text + "]";
+}
+
+bool ListObj::equals(const ListObj& other) const {
+  if (size() != other.size()) return false;
+  if (m_unboxed && other.m_unboxed) return m_ints == other.m_ints;
+  for (size_t i = 0; i < size(); i++) {
+    if (get(i) != other.get(i)) return false;
+  }
+  return true;
+}
+
+void ListObj::box() {
+  m_values.reserve(m_ints.size() + 1);
+  for (int64_t value : m_ints) m_values.push_back(Value::integer(value));
+  m_ints.clear();
+  m_ints.shrink_to_fit();
+  m_unboxed = false;
+}
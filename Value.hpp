@@ -0,0 +1,244 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BigInt.hpp"
+
+namespace PyInterpreter {
+class ListObj;
+class PyCallable;
+struct Builtin;
+
+// Reference-counted payload for the values that do not fit inline. The
+// count is atomic because literals in a parsed program may be copied by
+// interpreters on several threads at once.
+class Object {
+ public:
+  Object() : refs(1) {}
+  virtual ~Object() {}
+
+  std::atomic<int> refs;
+};
+
+class StringObj : public Object {
+ public:
+  StringObj(std::string val) : value(std::move(val)) {}
+
+  const std::string value;
+};
+
+class BigIntObj : public Object {
+ public:
+  BigIntObj(BigInt val) : value(std::move(val)) {}
+
+  const BigInt value;
+};
+
+// Runtime value: a type tag plus an inline payload. Ints, booleans, none and
+// function references never touch the heap; strings share a refcounted
+// StringObj between copies, and lists a ListObj, which copies also mutate.
+// Integers outside the int64_t range are BIGINT, and only those: an integer
+// that fits is always INT.
+class Value {
+ public:
+  enum class Type : uint8_t {
+    NONE,
+    BOOL,
+    INT,
+    BIGINT,
+    STRING,
+    FUNCTION,
+    LIST,
+    BUILTIN
+  };
+
+  Value() : m_type(Type::NONE) { m_as.integer = 0; }
+  Value(const Value& other) : m_type(other.m_type), m_as(other.m_as) {
+    retain();
+  }
+  Value(Value&& other) : m_type(other.m_type), m_as(other.m_as) {
+    other.m_type = Type::NONE;
+  }
+  ~Value() { release(); }
+
+  Value& operator=(const Value& other) {
+    if (this != &other) {
+      other.retain();
+      release();
+      m_type = other.m_type;
+      m_as = other.m_as;
+    }
+    return *this;
+  }
+  Value& operator=(Value&& other) {
+    if (this != &other) {
+      release();
+      m_type = other.m_type;
+      m_as = other.m_as;
+      other.m_type = Type::NONE;
+    }
+    return *this;
+  }
+
+  static Value none() { return Value(); }
+  static Value boolean(bool b) {
+    Value v(Type::BOOL);
+    v.m_as.boolean = b;
+    return v;
+  }
+  static Value integer(int64_t i) {
+    Value v(Type::INT);
+    v.m_as.integer = i;
+    return v;
+  }
+  static Value bigint(BigInt b) {
+    if (b.fitsInt64()) return integer(b.toInt64());
+    Object* object = new BigIntObj(std::move(b));
+    Value v(Type::BIGINT);
+    v.m_as.object = object;
+    return v;
+  }
+  static Value string(std::string s) {
+    Value v(Type::STRING);
+    v.m_as.object = new StringObj(std::move(s));
+    return v;
+  }
+  static Value function(PyCallable* fn) {
+    Value v(Type::FUNCTION);
+    v.m_as.function = fn;
+    return v;
+  }
+  // Takes over the reference list was created with.
+  static Value list(ListObj* list);
+  static Value builtin(const Builtin* builtin) {
+    Value v(Type::BUILTIN);
+    v.m_as.builtin = builtin;
+    return v;
+  }
+
+  Type type() const { return m_type; }
+  bool isNone() const { return m_type == Type::NONE; }
+  bool isBool() const { return m_type == Type::BOOL; }
+  bool isInt() const { return m_type == Type::INT; }
+  bool isBigInt() const { return m_type == Type::BIGINT; }
+  bool isNumber() const { return isInt() || isBigInt(); }
+  bool isString() const { return m_type == Type::STRING; }
+  bool isFunction() const { return m_type == Type::FUNCTION; }
+  bool isList() const { return m_type == Type::LIST; }
+  bool isBuiltin() const { return m_type == Type::BUILTIN; }
+
+  bool asBool() const { return m_as.boolean; }
+  int64_t asInt() const { return m_as.integer; }
+  const std::string& asString() const {
+    return static_cast<StringObj*>(m_as.object)->value;
+  }
+  const BigInt& asBigInt() const {
+    return static_cast<BigIntObj*>(m_as.object)->value;
+  }
+  PyCallable* asFunction() const { return m_as.function; }
+  ListObj* asList() const;
+  const Builtin* asBuiltin() const { return m_as.builtin; }
+  // Either kind of integer, widened.
+  BigInt toBigInt() const { return isInt() ? BigInt(asInt()) : asBigInt(); }
+
+  bool truthy() const;
+  std::string str() const;
+  bool operator==(const Value& other) const;
+  bool operator!=(const Value& other) const { return !(*this == other); }
+
+ private:
+  explicit Value(Type type) : m_type(type) {}
+
+  bool isObject() const {
+    return m_type == Type::STRING || m_type == Type::BIGINT ||
+           m_type == Type::LIST;
+  }
+  void retain() const {
+    if (isObject()) m_as.object->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+  void release() {
+    if (isObject() &&
+        m_as.object->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete m_as.object;
+    }
+  }
+
+  Type m_type;
+  union {
+    bool boolean;
+    int64_t integer;
+    Object* object;
+    PyCallable* function;
+    const Builtin* builtin;
+  } m_as;
+};
+
+// A list's elements are stored unboxed, as int64_t, while every one of them
+// is an INT. Storing anything else boxes them all into Values for good, so
+// lists of ints can be handed to the vector kernels as they are. A list
+// holding itself is never freed.
+class ListObj : public Object {
+ public:
+  ListObj() {}
+  explicit ListObj(std::vector<int64_t> ints) : m_ints(std::move(ints)) {}
+
+  bool unboxed() const { return m_unboxed; }
+  size_t size() const {
+    return m_unboxed ? m_ints.size() : m_values.size();
+  }
+  // The elements, while unboxed().
+  const std::vector<int64_t>& ints() const { return m_ints; }
+  // The elements, once boxed.
+  const std::vector<Value>& values() const { return m_values; }
+
+  Value get(size_t index) const {
+    return m_unboxed ? Value::integer(m_ints[index]) : m_values[index];
+  }
+  void set(size_t index, const Value& value) {
+    if (m_unboxed && value.isInt()) {
+      m_ints[index] = value.asInt();
+      return;
+    }
+    if (m_unboxed) box();
+    m_values[index] = value;
+  }
+  void append(const Value& value) {
+    if (m_unboxed && value.isInt()) {
+      m_ints.push_back(value.asInt());
+      return;
+    }
+    if (m_unboxed) box();
+    m_values.push_back(value);
+  }
+  void reserve(size_t size) {
+    if (m_unboxed) {
+      m_ints.reserve(size);
+    } else {
+      m_values.reserve(size);
+    }
+  }
+
+  std::string str() const;
+  bool equals(const ListObj& other) const;
+
+ private:
+  void box();
+
+  bool m_unboxed = true;
+  std::vector<int64_t> m_ints;
+  std::vector<Value> m_values;
+};
+
+inline Value Value::list(ListObj* list) {
+  Value v(Type::LIST);
+  v.m_as.object = list;
+  return v;
+}
+
+inline ListObj* Value::asList() const {
+  return static_cast<ListObj*>(m_as.object);
+}
+}  // namespace PyInterpreter
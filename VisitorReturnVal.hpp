@@ -2,17 +2,22 @@
 // https://www.codeproject.com/Tips/1018315/Visitor-with-the-Return-Value
 #pragma once
 
+#include <utility>
+
+// Unlike the original, GetValue visits with the calling instance instead of
+// default-constructing a fresh visitor per node, so visitor state (call
+// frames, completion flags) is shared across nested evaluations. Every visit
+// must end with Return().
 template <typename VisitorImpl, typename VisitablePtr, typename ResultType>
 class VisitorReturnVal {
  public:
   ResultType GetValue(VisitablePtr n) {
-    VisitorImpl vis;
-    n->accept(vis);
-    return vis.value;
+    n->accept(static_cast<VisitorImpl&>(*this));
+    return std::move(value);
   }
 
-  void Return(ResultType val) { value = val; }
+  void Return(ResultType val) { value = std::move(val); }
 
  private:
   ResultType value;
-};
\ No newline at end of file
+};
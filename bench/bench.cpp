@@ -0,0 +1,472 @@
+// Benchmark driver: runs each script repeatedly through the same pipeline as
+// mypython, timing every phase separately, and prints the results as JSON.
+// Given a baseline file (a previous run's JSON), it also flags every phase
+// whose median got slower than the threshold allows and exits with status 1.
+//
+// Build from the repository root:
+//   g++ -std=c++17 -O2 -I. bench/bench.cpp $(ls *.cpp | grep -v mypython.cpp) -o pybench
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "Python.hpp"
+
+using namespace PyInterpreter;
+
+namespace {
+const char* const kPhases[] = {"scan", "parse", "resolve", "execute", "total"};
+const int kPhaseCount = 5;
+const int kParsePhase = 1;
+// Medians below this are too small to compare against a baseline.
+const double kNoiseFloorMs = 0.05;
+
+struct Config {
+  int runs = 10;
+  int warmup = 1;
+  bool useVM = false;
+  bool optimize = false;
+  bool memoize = true;
+  double thresholdPercent = 10;
+  size_t generateBytes = 0;
+  std::string generateMegabytes;
+  std::string baseline;
+  std::string output;
+  std::vector<std::string> files;
+};
+
+struct Summary {
+  double median, p90, p99, min, max, mean;
+};
+
+struct Result {
+  std::string name;
+  size_t bytes = 0;
+  bool failed = false;
+  Summary phases[kPhaseCount];
+};
+
+// Discards scanner and parser messages, which still go through std::cout.
+class NullBuffer : public std::streambuf {
+ protected:
+  int overflow(int c) { return c; }
+  std::streamsize xsputn(const char*, std::streamsize count) { return count; }
+};
+
+// A deterministic script of roughly the requested size: many small
+// functions with constant configuration arithmetic, each called once.
+std::string generateSource(size_t bytes) {
+  std::ostringstream out;
+  out << "# generated benchmark source\n";
+  for (int i = 0; static_cast<size_t>(out.tellp()) < bytes; i++) {
+    out << "def f" << i << "(a, b):\n"
+        << "    c = a * " << (i % 13 + 2) << " + b - (" << (i % 7) << " + 2 * 3)\n"
+        << "    if c > " << (i % 100) << ":\n"
+        << "        return c - " << (i % 100) << "\n"
+        << "    return c\n"
+        << "v" << i << " = f" << i << "(" << i << ", 4 * 5 + 1)\n";
+  }
+  out << "print(\"done\")\n";
+  return out.str();
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+  size_t rank = static_cast<size_t>(std::ceil(p / 100 * sorted.size()));
+  return sorted[rank == 0 ? 0 : rank - 1];
+}
+
+Summary summarize(std::vector<double> samples) {
+  std::sort(samples.begin(), samples.end());
+  Summary summary;
+  size_t n = samples.size();
+  summary.median = n % 2 == 1 ? samples[n / 2]
+                              : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+  summary.p90 = percentile(samples, 90);
+  summary.p99 = percentile(samples, 99);
+  summary.min = samples.front();
+  summary.max = samples.back();
+  double sum = 0;
+  for (double sample : samples) sum += sample;
+  summary.mean = sum / n;
+  return summary;
+}
+
+// Runs the script once, printing to the file descriptor discard and adding
+// each phase's time in milliseconds to samples. Returns false if the script
+// does not parse or compile.
+bool runOnce(const Config& config, std::string_view text, int discard,
+             std::vector<double> samples[kPhaseCount]) {
+  typedef std::chrono::steady_clock Clock;
+  auto elapsed = [](Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+        .count();
+  };
+
+  Program program;
+  Clock::time_point start = Clock::now();
+  Clock::time_point phase = start;
+  std::vector<Token> tokens = Scanner(text).scanTokens();
+  double scan = elapsed(phase);
+
+  phase = Clock::now();
+  Parser parser(std::move(tokens), program.arena);
+  program.statements = parser.parse();
+  if (parser.hadError()) return false;
+  double parse = elapsed(phase);
+
+  phase = Clock::now();
+  Resolver().resolve(program.statements);
+  if (config.optimize) Optimizer(program.arena).optimize(program.statements);
+  std::unique_ptr<CompiledProgram> compiled;
+  if (config.useVM) {
+    try {
+      compiled = Compiler().compile(program.statements);
+    } catch (const std::runtime_error&) {
+      return false;
+    }
+  } else if (config.memoize) {
+    PurityAnalysis().analyze(program.statements);
+  }
+  double resolve = elapsed(phase);
+
+  phase = Clock::now();
+  {
+    OutputSink out(discard, OutputSink::FlushPolicy::SIZE);
+    if (config.useVM) {
+      VM(out).interpret(*compiled);
+    } else {
+      Interpreter(out).interpret(program.statements);
+    }
+  }
+  double execute = elapsed(phase);
+
+  const double times[kPhaseCount] = {scan, parse, resolve, execute,
+                                     elapsed(start)};
+  for (int i = 0; i < kPhaseCount; i++) samples[i].push_back(times[i]);
+  return true;
+}
+
+Result benchmark(const Config& config, const std::string& name,
+                 std::string_view text) {
+  Result result;
+  result.name = name;
+  result.bytes = text.size();
+
+  // Script output is written to /dev/null so that terminal speed does not
+  // skew execute times, while the cost of the write calls still counts.
+  NullBuffer null;
+  std::streambuf* console = std::cout.rdbuf(&null);
+  const int discard = open("/dev/null", O_WRONLY);
+  std::vector<double> samples[kPhaseCount];
+  for (int run = 0; run < config.warmup + config.runs; run++) {
+    std::vector<double> discarded[kPhaseCount];
+    if (!runOnce(config, text, discard, run < config.warmup ? discarded : samples)) {
+      result.failed = true;
+      break;
+    }
+  }
+  close(discard);
+  std::cout.rdbuf(console);
+
+  if (!result.failed) {
+    for (int i = 0; i < kPhaseCount; i++) {
+      result.phases[i] = summarize(samples[i]);
+    }
+  }
+  return result;
+}
+
+std::string quote(const std::string& text) {
+  std::string out = "\"";
+  for (char c : text) {
+    if (c == '"' || c == '\\') out += '\\';
+    out += c;
+  }
+  return out + "\"";
+}
+
+void writeJson(std::ostream& out, const Config& config,
+               const std::vector<Result>& results) {
+  out << "{\n"
+      << "  \"engine\": " << quote(config.useVM ? "vm" : "tree") << ",\n"
+      << "  \"optimize\": " << (config.optimize ? "true" : "false") << ",\n"
+      << "  \"memoize\": " << (config.memoize ? "true" : "false") << ",\n"
+      << "  \"runs\": " << config.runs << ",\n"
+      << "  \"benchmarks\": [";
+  for (size_t b = 0; b < results.size(); b++) {
+    const Result& result = results[b];
+    out << (b == 0 ? "\n" : ",\n") << "    {\n"
+        << "      \"name\": " << quote(result.name) << ",\n"
+        << "      \"bytes\": " << result.bytes << ",\n"
+        << "      \"failed\": " << (result.failed ? "true" : "false");
+    if (!result.failed) {
+      // Source bytes over the median parse time.
+      const double parseMs = result.phases[kParsePhase].median;
+      out << ",\n      \"parse_mb_per_s\": "
+          << (parseMs > 0 ? result.bytes / 1e6 / (parseMs / 1e3) : 0);
+      for (int i = 0; i < kPhaseCount; i++) {
+        const Summary& s = result.phases[i];
+        out << ",\n      " << quote(kPhases[i]) << ": {\"median_ms\": "
+            << s.median << ", \"p90_ms\": " << s.p90 << ", \"p99_ms\": "
+            << s.p99 << ", \"min_ms\": " << s.min << ", \"max_ms\": " << s.max
+            << ", \"mean_ms\": " << s.mean << "}";
+      }
+    }
+    out << "\n    }";
+  }
+  out << "\n  ]\n}\n";
+}
+
+// Just enough JSON to read back a baseline written by writeJson: the median
+// of each phase, keyed by benchmark name and then phase.
+class BaselineReader {
+ public:
+  BaselineReader(const std::string& text) : m_text(text) {}
+
+  bool read(std::map<std::string, std::map<std::string, double>>& medians) {
+    m_medians = &medians;
+    skipValue(0);
+    skipSpace();
+    return m_ok && m_pos == m_text.size();
+  }
+
+ private:
+  // depth 0 is the document, 2 a benchmark object, 3 a phase object.
+  void skipValue(int depth) {
+    skipSpace();
+    if (m_pos >= m_text.size()) return fail();
+    char c = m_text[m_pos];
+    if (c == '{') {
+      readObject(depth);
+    } else if (c == '[') {
+      m_pos++;
+      skipSpace();
+      if (peek() == ']') {
+        m_pos++;
+        return;
+      }
+      do {
+        skipValue(depth + 1);
+        skipSpace();
+      } while (m_ok && consume(','));
+      if (!consume(']')) fail();
+    } else if (c == '"') {
+      readString();
+    } else {
+      readNumber();
+    }
+  }
+
+  void readObject(int depth) {
+    m_pos++;
+    skipSpace();
+    if (consume('}')) return;
+    std::string name;
+    do {
+      skipSpace();
+      std::string key = readString();
+      skipSpace();
+      if (!consume(':')) return fail();
+      skipSpace();
+      if (depth == 2 && key == "name") {
+        name = readString();
+        m_benchmark = name;
+      } else if (depth == 3 && key == "median_ms") {
+        (*m_medians)[m_benchmark][m_phase] = readNumber();
+      } else {
+        if (depth == 2) m_phase = key;
+        skipValue(depth + 1);
+      }
+      skipSpace();
+    } while (m_ok && consume(','));
+    if (!consume('}')) fail();
+  }
+
+  std::string readString() {
+    std::string out;
+    if (!consume('"')) {
+      fail();
+      return out;
+    }
+    while (m_pos < m_text.size() && m_text[m_pos] != '"') {
+      if (m_text[m_pos] == '\\') m_pos++;
+      if (m_pos < m_text.size()) out += m_text[m_pos++];
+    }
+    if (!consume('"')) fail();
+    return out;
+  }
+
+  double readNumber() {
+    const char* begin = m_text.c_str() + m_pos;
+    char* end;
+    double value = std::strtod(begin, &end);
+    if (end == begin) {
+      // true, false and null
+      while (m_pos < m_text.size() && std::isalpha(m_text[m_pos])) m_pos++;
+      if (m_text.c_str() + m_pos == begin) fail();
+      return 0;
+    }
+    m_pos += end - begin;
+    return value;
+  }
+
+  void skipSpace() {
+    while (m_pos < m_text.size() && std::isspace(m_text[m_pos])) m_pos++;
+  }
+  char peek() const { return m_pos < m_text.size() ? m_text[m_pos] : '\0'; }
+  bool consume(char c) {
+    if (peek() != c) return false;
+    m_pos++;
+    return true;
+  }
+  void fail() {
+    m_ok = false;
+    m_pos = m_text.size();
+  }
+
+  const std::string& m_text;
+  size_t m_pos = 0;
+  bool m_ok = true;
+  std::string m_benchmark;
+  std::string m_phase;
+  std::map<std::string, std::map<std::string, double>>* m_medians = nullptr;
+};
+
+// Prints every regression past the threshold; returns how many there were.
+int compareBaseline(const Config& config, const std::vector<Result>& results) {
+  std::ifstream file(config.baseline);
+  if (!file) {
+    std::cerr << "Could not open baseline " << config.baseline << std::endl;
+    return -1;
+  }
+  std::stringstream contents;
+  contents << file.rdbuf();
+  const std::string text = contents.str();
+  std::map<std::string, std::map<std::string, double>> baseline;
+  if (!BaselineReader(text).read(baseline)) {
+    std::cerr << "Malformed baseline " << config.baseline << std::endl;
+    return -1;
+  }
+
+  int regressions = 0;
+  for (const Result& result : results) {
+    if (result.failed) continue;
+    auto found = baseline.find(result.name);
+    if (found == baseline.end()) {
+      // Baselines are keyed by the path as given, so a renamed script or
+      // an absolute path would otherwise go unchecked without notice.
+      std::cerr << "warning: " << result.name << " has no entry in "
+                << config.baseline << std::endl;
+      continue;
+    }
+    for (int i = 0; i < kPhaseCount; i++) {
+      auto phase = found->second.find(kPhases[i]);
+      if (phase == found->second.end() || phase->second < kNoiseFloorMs) {
+        continue;
+      }
+      double before = phase->second;
+      double now = result.phases[i].median;
+      double change = (now - before) / before * 100;
+      if (change > config.thresholdPercent) {
+        std::cerr << "regression: " << result.name << " " << kPhases[i]
+                  << " median " << before << " ms -> " << now << " ms (+"
+                  << static_cast<int>(change) << "%)" << std::endl;
+        regressions++;
+      }
+    }
+  }
+  return regressions;
+}
+
+bool parseArguments(int argc, char* argv[], Config& config) {
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--vm") {
+      config.useVM = true;
+    } else if (arg == "-O") {
+      config.optimize = true;
+    } else if (arg == "--no-memo") {
+      config.memoize = false;
+    } else if (arg == "--runs" && hasValue) {
+      config.runs = std::atoi(argv[++i]);
+    } else if (arg == "--warmup" && hasValue) {
+      config.warmup = std::atoi(argv[++i]);
+    } else if (arg == "--baseline" && hasValue) {
+      config.baseline = argv[++i];
+    } else if (arg == "--threshold" && hasValue) {
+      config.thresholdPercent = std::atof(argv[++i]);
+    } else if (arg == "--output" && hasValue) {
+      config.output = argv[++i];
+    } else if (arg == "--generate" && hasValue) {
+      config.generateMegabytes = argv[++i];
+      config.generateBytes = std::atof(argv[i]) * 1024 * 1024;
+    } else if (arg[0] != '-') {
+      config.files.push_back(arg);
+    } else {
+      return false;
+    }
+  }
+  return config.runs > 0 && config.warmup >= 0 &&
+         (!config.files.empty() || config.generateBytes > 0);
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Config config;
+  if (!parseArguments(argc, argv, config)) {
+    std::cerr << "Usage: pybench [--vm] [-O] [--no-memo] [--runs N] "
+                 "[--warmup N] [--generate MB]\n"
+                 "               [--baseline file.json] [--threshold percent] "
+                 "[--output file.json] [file.py ...]"
+              << std::endl;
+    return 2;
+  }
+
+  std::vector<Result> results;
+  for (const std::string& file : config.files) {
+    std::unique_ptr<SourceBuffer> source = SourceBuffer::open(file);
+    if (source == nullptr) {
+      std::cerr << "Could not open " << file << std::endl;
+      return 2;
+    }
+    results.push_back(benchmark(config, file, source->text()));
+  }
+  if (config.generateBytes > 0) {
+    std::unique_ptr<SourceBuffer> source =
+        SourceBuffer::fromString(generateSource(config.generateBytes));
+    results.push_back(benchmark(
+        config, "generated:" + config.generateMegabytes + "MB", source->text()));
+  }
+
+  if (config.output.empty()) {
+    writeJson(std::cout, config, results);
+  } else {
+    std::ofstream out(config.output);
+    writeJson(out, config, results);
+  }
+
+  int status = 0;
+  for (const Result& result : results) {
+    if (result.failed) {
+      std::cerr << "failed: " << result.name << std::endl;
+      status = 1;
+    }
+  }
+  if (!config.baseline.empty() && compareBaseline(config, results) != 0) {
+    status = 1;
+  }
+  return status;
+}
@@ -0,0 +1,32 @@
+# Integers far past 64 bits: long products, repeated squaring and division.
+def factorial(n):
+    if n < 2:
+        return 1
+    return n * factorial(n - 1)
+
+def power(base, exponent):
+    if exponent == 0:
+        return 1
+    half = power(base, exponent / 2)
+    if exponent - (exponent / 2) * 2 == 0:
+        return half * half
+    return half * half * base
+
+def digits(n):
+    if n < 10:
+        return 1
+    return 1 + digits(n / 1000000000) + 8
+
+def sumFactorials(n, acc):
+    if n == 0:
+        return acc
+    return sumFactorials(n - 1, acc + factorial(n))
+
+f = factorial(1000)
+p = power(2, 10000)
+q = power(3, 40000)
+print("factorial", f)
+print("power", p)
+print("quotient", q / p)
+print("digits", digits(q))
+print("sum", sumFactorials(300, 0) / factorial(290))
@@ -0,0 +1,26 @@
+# Call-heavy code: many shallow calls to small helpers that print nothing
+# but are not pure, so every call really executes.
+counter = 0
+
+def clamp(x, lo, hi):
+    if x < lo:
+        return lo
+    if x > hi:
+        return hi
+    return x
+
+def score(a, b):
+    return clamp(a * 3 - b, 0, 1000) + clamp(b * 2 - a, 0, 1000)
+
+def tally(n, acc):
+    if n == 0:
+        return acc
+    return tally(n - 1, acc + score(n, counter + n / 2))
+
+def rounds(n, acc):
+    if n == 0:
+        return acc
+    return rounds(n - 1, acc + tally(2000, 0))
+
+print("calls", rounds(20, 0))
+counter = 1
@@ -0,0 +1,81 @@
+// Embedding benchmark: the cost of a request that calls a script function,
+// first paying the whole pipeline (read, scan, parse, resolve, run the top
+// level) per request, then through one Script loaded up front. The function
+// must take a single int; request i passes i.
+//
+// Build from the repository root:
+//   g++ -std=c++17 -O2 -I. bench/embed.cpp $(ls *.cpp | grep -v mypython.cpp) -o pyembed
+//   ./pyembed bench/scoring.py score
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "Python.hpp"
+
+using namespace PyInterpreter;
+
+namespace {
+const int kDefaultRequests = 20000;
+
+double microsPerRequest(std::chrono::steady_clock::time_point start,
+                        int requests) {
+  const std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / requests;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc != 3 && !(argc == 5 && std::string(argv[3]) == "--requests")) {
+    std::cerr << "Usage: pyembed <file.py> <function> [--requests N]"
+              << std::endl;
+    return 2;
+  }
+  const std::string file = argv[1];
+  const std::string name = argv[2];
+  const int requests = argc == 5 ? std::atoi(argv[4]) : kDefaultRequests;
+  if (requests <= 0) return 2;
+
+  // Memoization would answer repeated arguments without running anything.
+  Options options;
+  options.memoize = false;
+  const Python python(options);
+
+  try {
+    int64_t reloaded = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < requests; i++) {
+      reloaded += python.load(file)->call(name, {Value::integer(i)}).asInt();
+    }
+    const double reloadMicros = microsPerRequest(start, requests);
+
+    int64_t reused = 0;
+    start = std::chrono::steady_clock::now();
+    std::unique_ptr<Script> script = python.load(file);
+    PyCallable* function = script->function(name);
+    if (function == nullptr) {
+      throw std::runtime_error("No function named " + name + ".");
+    }
+    for (int i = 0; i < requests; i++) {
+      reused += script->call(function, {Value::integer(i)}).asInt();
+    }
+    const double reuseMicros = microsPerRequest(start, requests);
+
+    if (reloaded != reused) {
+      std::cerr << "Results differ: " << reloaded << " vs " << reused
+                << std::endl;
+      return 1;
+    }
+    std::cout << "requests " << requests << ", checksum " << reused << "\n"
+              << "load per request " << reloadMicros << " us\n"
+              << "loaded once      " << reuseMicros << " us" << std::endl;
+  } catch (const std::runtime_error& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,32 @@
+# Aggregates over a 100000-element int list: the sum, min and max builtins
+# and element-wise add/multiply, each repeated, next to the same sum done
+# one element at a time in a loop. Run with --simd sse2 or --simd scalar to
+# compare the kernels.
+def build(n):
+    xs = []
+    for i in range(n):
+        xs.append(i * 7 - n)
+    return xs
+
+def loop_sum(xs):
+    total = 0
+    for i in range(len(xs)):
+        total = total + xs[i]
+    return total
+
+def kernel_sums(xs, times):
+    total = 0
+    for i in range(times):
+        total = total + sum(xs) + min(xs) + max(xs)
+    return total
+
+def kernel_arithmetic(xs, times):
+    ys = xs
+    for i in range(times):
+        ys = add(ys, xs)
+    return sum(multiply(ys, 3))
+
+xs = build(100000)
+print("loop", loop_sum(xs))
+print("kernels", kernel_sums(xs, 1000))
+print("elementwise", kernel_arithmetic(xs, 1000))
@@ -0,0 +1,34 @@
+# The same sum of squares computed by tail recursion, plain recursion, a
+# while loop and a for loop. Everything reads a global that is bound twice,
+# so none of it is memoized.
+offset = 0
+
+def sum_tail(i, n, acc):
+    if i == n:
+        return acc
+    return sum_tail(i + 1, n, acc + i * i + offset)
+
+def sum_recursive(i, n):
+    if i == n:
+        return 0
+    return i * i + offset + sum_recursive(i + 1, n)
+
+def sum_while(n):
+    acc = 0
+    i = 0
+    while i < n:
+        acc = acc + i * i + offset
+        i = i + 1
+    return acc
+
+def sum_for(n):
+    acc = 0
+    for i in range(n):
+        acc = acc + i * i + offset
+    return acc
+
+print("tail", sum_tail(0, 200000, 0))
+print("recursive", sum_recursive(0, 200000))
+print("while", sum_while(200000))
+print("for", sum_for(200000))
+offset = 1
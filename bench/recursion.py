@@ -0,0 +1,21 @@
+
+# Deep and call-heavy recursion: every call returns through the interpreter.
+def fib(n):
+    if n < 2:
+        return n
+    return fib(n - 1) + fib(n - 2)
+
+def depth(n):
+    if n == 0:
+        return 0
+    return 1 + depth(n - 1)
+
+def factorial(n):
+    if n < 2:
+        return 1
+    else:
+        return n * factorial(n - 1)
+
+print("fib", fib(22))
+print("depth", depth(3000))
+print("factorial", factorial(20))
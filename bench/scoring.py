@@ -0,0 +1,19 @@
+# Scoring function for bench/embed.cpp, which loads this file once and
+# calls score(request) per simulated request.
+weight = 7
+cap = 5000
+
+def clamp(x, lo, hi):
+    if x < lo:
+        return lo
+    if x > hi:
+        return hi
+    return x
+
+def digits(n, acc):
+    if n == 0:
+        return acc
+    return digits(n / 10, acc + n - n / 10 * 10)
+
+def score(request):
+    return clamp(digits(request, 0) * weight + request / 97, 0, cap)
@@ -0,0 +1,24 @@
+# String concatenation and comparison: every + allocates a new string.
+def repeat(s, n):
+    if n == 0:
+        return ""
+    return s + repeat(s, n - 1)
+
+def build(n, acc):
+    if n == 0:
+        return acc
+    return build(n - 1, acc + "x" + n)
+
+def longer(a, b):
+    if a > b:
+        return a
+    return b
+
+def labels(n, acc):
+    if n == 0:
+        return acc
+    return labels(n - 1, longer(acc, "item-" + n))
+
+print("repeat", repeat("ab", 2000) == repeat("ab", 2000))
+print("build", build(3000, "") < "y")
+print("labels", labels(20000, ""))
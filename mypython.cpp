@@ -1,16 +1,102 @@
 // Interpreter created using Crafting Interpreters by Robert Nystrom for
 // reference https://craftinginterpreters.com/contents.html
 
+#include <cstdlib>
 #include <iostream>
+#include <string>
+#include <vector>
 
+#include "Kernels.hpp"
 #include "Python.hpp"
 
 int main(int argc, char* argv[]) {
-  if (argc != 2) {
+  PyInterpreter::Options options;
+  std::vector<std::string> files;
+  int jobs = 0;
+  bool valid = true;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--vm") {
+      options.useVM = true;
+    } else if (arg == "-O") {
+      options.optimize = true;
+    } else if (arg == "--no-memo") {
+      options.memoize = false;
+    } else if (arg == "--memo-stats") {
+      options.memoStats = true;
+    } else if (arg == "--max-depth" && i + 1 < argc) {
+      options.maxDepth = std::atoi(argv[++i]);
+      if (options.maxDepth <= 0) {
+        valid = false;
+        break;
+      }
+    } else if (arg == "--profile" && i + 1 < argc) {
+      options.profileFile = argv[++i];
+    } else if (arg == "--flush" && i + 1 < argc) {
+      const std::string policy = argv[++i];
+      if (policy == "line") {
+        options.flushPolicy = PyInterpreter::OutputSink::FlushPolicy::LINE;
+      } else if (policy == "size") {
+        options.flushPolicy = PyInterpreter::OutputSink::FlushPolicy::SIZE;
+      } else if (policy == "exit") {
+        options.flushPolicy = PyInterpreter::OutputSink::FlushPolicy::EXIT;
+      } else {
+        valid = false;
+        break;
+      }
+    } else if (arg == "--simd" && i + 1 < argc) {
+      const std::string level = argv[++i];
+      if (level == "avx2") {
+        PyInterpreter::Kernels::limit(PyInterpreter::Kernels::Level::AVX2);
+      } else if (level == "sse2") {
+        PyInterpreter::Kernels::limit(PyInterpreter::Kernels::Level::SSE2);
+      } else if (level == "scalar") {
+        PyInterpreter::Kernels::limit(PyInterpreter::Kernels::Level::SCALAR);
+      } else {
+        valid = false;
+        break;
+      }
+    } else if (arg == "--cache" && i + 1 < argc) {
+      options.cacheDirectory = argv[++i];
+    } else if (arg == "--jit") {
+      options.jit = true;
+    } else if (arg == "--jit-stats") {
+      options.jitStats = true;
+    } else if (arg == "--stream") {
+      options.stream = true;
+    } else if (arg == "--async-output") {
+      options.asyncOutput = true;
+    } else if (arg == "--jobs" && i + 1 < argc) {
+      jobs = std::atoi(argv[++i]);
+      if (jobs <= 0) {
+        valid = false;
+        break;
+      }
+    } else if (arg[0] != '-') {
+      files.push_back(arg);
+    } else {
+      valid = false;
+      break;
+    }
+  }
+
+  // Several scripts are only accepted as a --jobs batch.
+  if (files.empty() || (files.size() > 1 && jobs == 0)) valid = false;
+  if (!valid) {
+    std::cerr << "Usage: mypython [--vm] [-O] [--no-memo] [--memo-stats] "
+                 "[--max-depth N] [--profile FILE]\n"
+                 "                [--flush line|size|exit] [--async-output]\n"
+                 "                [--stream] [--cache DIR] [--jit] [--jit-stats]\n"
+                 "                [--simd avx2|sse2|scalar] <file.py>\n"
+                 "       mypython --jobs N [options] <file.py>..."
+              << std::endl;
     return -1;
+  }
+  PyInterpreter::Python interpreter{options};
+  if (jobs > 0) {
+    interpreter.runAll(files, jobs);
   } else {
-    PyInterpreter::Python interpreter{};
-    interpreter.run(argv[1]);
+    interpreter.run(files.front());
   }
   return 0;
-}
\ No newline at end of file
+}
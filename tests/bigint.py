@@ -0,0 +1,54 @@
+# mypython
+# mypython --vm
+# mypython -O
+# mypython --jit
+# mypython --jit --no-memo
+# mypython --stream
+# Ints overflow into BigInts and results that fit come back as ints. The
+# large products are past the Karatsuba threshold (48 limbs of 10^9) and
+# are checked against identities and schoolbook-sized products.
+def power(base, exponent):
+    if exponent == 0:
+        return 1
+    half = power(base, exponent / 2)
+    if exponent - (exponent / 2) * 2 == 0:
+        return half * half
+    return half * half * base
+
+def mod(a, m):
+    return a - (a / m) * m
+
+def factorial(n):
+    if n < 2:
+        return 1
+    return n * factorial(n - 1)
+
+def digits(n):
+    if n < 10:
+        return 1
+    return 1 + digits(n / 10)
+
+big = 9223372036854775807
+small = -9223372036854775807 - 1
+print(big + 1, small - 1)
+print(big * 2, small * 2, big * big)
+print(small / -1, small * -1, -small)
+print(small / -1 / -1, -small - 1 == big)
+print(3037000499 * 3037000499, 3037000500 * 3037000500)
+print(9223372036854775808 - 1, 9223372036854775808 + small)
+print(-9223372036854775809 + 1 == small, big + 1 > big, small - 1 < small)
+print(-7 / 2, 7 / -2, (big + 1) / -2, (small - 1) / 2)
+
+print(factorial(25))
+print(factorial(100) / factorial(98))
+
+a = power(3, 2000)
+b = power(7, 1500)
+c = power(10, 300) + 12345
+print(digits(a), digits(b), digits(a * b))
+print(mod(a, 1000000007), mod(b, 1000000007), mod(a * b, 1000000007))
+print((a * b) / b == a, (a * b) / a == b, a * b == b * a)
+print(a * b == a * (b - c) + a * c)
+print(a * a - b * b == (a - b) * (a + b))
+print(mod(-a * b, 1000000007), (-a * b) / a == -b)
+print(power(2, 1000))
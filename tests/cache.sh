@@ -0,0 +1,75 @@
+#!/bin/sh
+# --cache: a valid entry is used as is, and an entry that is corrupt, from
+# another format version or for other contents is rebuilt. Editing a
+# script gives it a new entry.
+binary=$1
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+cat > "$dir/a.py" <<'PY'
+# Every kind of node the cache stores.
+def fib(n):
+    if n < 2:
+        return n
+    else:
+        return fib(n - 1) + fib(n - 2)
+
+total = 0
+i = 0
+while i < 5 and !(total > 100):
+    total = total + fib(i) * -2
+    i = i + 1
+xs = [1, 2, 3]
+xs.append(len(xs))
+xs[0] = "one"
+for k in range(0, 10, 3):
+    total = total + k
+print(total, xs, xs[1] + 3, "done", true, none)
+PY
+mkdir "$dir/cache"
+expected=$("$binary" "$dir/a.py" 2>&1)
+
+fail() {
+  echo "FAIL: $1"
+  exit 1
+}
+# Runs a.py with the cache and checks its output.
+run() {
+  [ "$("$binary" --cache "$dir/cache" "$dir/a.py" 2>&1)" = "$expected" ] ||
+    fail "wrong output $1"
+}
+# Damages the entry with $1, then checks that a run restores it.
+rebuilt() {
+  "$@"
+  cmp -s "$entry" "$dir/good" && fail "$1 left the entry unchanged"
+  run "after $*"
+  cmp -s "$entry" "$dir/good" || fail "entry not rebuilt after $*"
+}
+patch() {
+  printf "$2" | dd of="$entry" bs=1 seek="$1" conv=notrunc 2> /dev/null
+}
+
+run "on the first run"
+entry=$(ls "$dir"/cache/*.pyac)
+[ -f "$entry" ] || fail "no entry written"
+cp "$entry" "$dir/good"
+
+# A valid entry is read, not rewritten.
+inode=$(ls -i "$entry")
+run "from the cache"
+[ "$(ls -i "$entry")" = "$inode" ] || fail "valid entry was rewritten"
+
+rebuilt patch 0 'XPAC'                # magic number
+rebuilt patch 4 '\377\377\0\0'        # format version
+rebuilt patch 8 '\1'                  # script hash
+rebuilt patch 60 '\377\376'           # payload, caught by its checksum
+rebuilt truncate -s 30 "$entry"       # shorter than the header
+rebuilt truncate -s -7 "$entry"       # payload cut short
+rebuilt cp /dev/null "$entry"
+
+# Editing the script makes a new entry and leaves the old one.
+echo 'print("edited")' >> "$dir/a.py"
+expected=$("$binary" "$dir/a.py" 2>&1)
+run "after an edit"
+[ "$(ls "$dir"/cache/*.pyac | wc -l)" -eq 2 ] || fail "no entry for the edit"
+[ -z "$(ls "$dir/cache" | grep -v '\.pyac$')" ] ||
+  fail "temporary files left: $(ls "$dir/cache")"
@@ -0,0 +1,9 @@
+# mypython --jit --memo-stats
+# A memoized function keeps its memo table under --jit. Native self-calls
+# would skip it, and fib(90) would then make about 10^19 calls.
+def fib(n):
+    if n < 2:
+        return n
+    return fib(n - 1) + fib(n - 2)
+
+print(fib(90))
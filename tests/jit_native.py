@@ -0,0 +1,25 @@
+# mypython --jit --no-memo --jit-stats
+# mypython --jit --no-memo --jit-stats --stream
+# Memoization is off, so these defs are compiled. fact(20) runs natively;
+# fact(21) overflows int64 in the native code and bails out, and the
+# interpreter's rerun promotes the product to a BigInt. ratio bails out on
+# division by zero, and the rerun reports the error.
+def fact(n):
+    if n < 2:
+        return 1
+    return n * fact(n - 1)
+
+def quot(a, b):
+    if a < b:
+        return 0
+    return quot(a - b, b) + 1
+
+def ratio(a, b):
+    return a / b
+
+print(fact(20))
+print(fact(21))
+print(fact(5))
+print(quot(1000, 7))
+print(ratio(7, 2))
+print(ratio(7, 0))
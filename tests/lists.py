@@ -0,0 +1,75 @@
+# mypython
+# mypython --vm
+# mypython -O
+# mypython --jit
+# mypython --stream
+# mypython --simd sse2
+# mypython --simd scalar
+# mypython --vm --simd scalar
+# Lists stay unboxed while they hold only ints and box for good otherwise;
+# the aggregate builtins give the same results at every --simd level, for
+# lengths around the vector widths and for overflow in any lane.
+def iota(n, start, step):
+    xs = []
+    for i in range(n):
+        xs.append(start + i * step)
+    return xs
+
+def boxedCopy(xs):
+    ys = xs + []
+    if len(ys) > 0:
+        first = ys[0]
+        ys[0] = "box"
+        ys[0] = first
+    return ys
+
+def loopSum(xs):
+    total = 0
+    for i in range(len(xs)):
+        total = total + xs[i]
+    return total
+
+xs = [3, -1, 4]
+xs.append(1)
+xs[0] = xs[-1] + 10
+print(xs, len(xs), xs[-4], xs + [[5], "six"], [])
+
+big = 9223372036854775807
+small = -9223372036854775807 - 1
+for n in range(18):
+    a = iota(n, -7, 3)
+    b = iota(n, 5, -2)
+    boxed = boxedCopy(a)
+    print(n, sum(a), sum(boxed), loopSum(a), add(a, b), subtract(a, 1))
+    if n > 0:
+        print(" ", min(a), max(a), min(boxed), max(b), multiply(a, b))
+    print(" ", add(a, b) == add(boxed, b), multiply(boxed, -1))
+
+def overflowIn(n, lane):
+    a = iota(n, 0, 0)
+    a[lane] = big
+    b = iota(n, 1, 0)
+    c = iota(n, 0, 0)
+    c[lane] = small
+    print(n, lane, sum(add(a, b)), subtract(c, b)[lane], sum(multiply(a, 2)))
+    print(" ", max(a), min(c), sum(a + a) == 2 * big, multiply(c, -1)[lane])
+
+for n in range(1, 18):
+    overflowIn(n, 0)
+    if n > 2:
+        overflowIn(n, n / 2)
+    if n > 1:
+        overflowIn(n, n - 1)
+
+mixed = [1, 2, 3]
+mixed[1] = "two"
+print(mixed, len(mixed))
+mixed[1] = 2
+print(mixed, sum(mixed), min(mixed), max(mixed), add(mixed, mixed))
+grown = [big]
+grown.append(big + 1)
+print(grown, sum(grown), max(grown))
+nested = [xs, [true, none], "s"]
+nested[0][0] = 99
+print(nested, xs[0])
+print(xs[4])
@@ -0,0 +1,78 @@
+# mypython
+# mypython --vm
+# mypython -O
+# mypython --jit --no-memo
+# mypython --stream
+# while and for-range: bounds evaluated once, the counter unaffected by
+# assignments to the loop variable, steps past the int64 range, and loops
+# inside functions returning from the middle.
+def bound(n):
+    print("bound", n)
+    return n
+
+def firstSquareOver(limit):
+    for i in range(1, limit):
+        if i * i > limit:
+            return i
+    return 0
+
+def collatz(n):
+    steps = 0
+    while n != 1:
+        if n - (n / 2) * 2 == 0:
+            n = n / 2
+        else:
+            n = 3 * n + 1
+        steps = steps + 1
+    return steps
+
+def triangle(n):
+    total = 0
+    i = 0
+    while i < n:
+        j = 0
+        while j <= i:
+            total = total + 1
+            j = j + 1
+        i = i + 1
+    return total
+
+total = 0
+for i in range(5):
+    total = total + i
+print("range(5)", total, i)
+
+total = 0
+for k in range(bound(2), bound(12), bound(3)):
+    total = total + k
+print("range(2, 12, 3)", total, k)
+
+for k in range(10, 0, -4):
+    print("down", k)
+
+for k in range(3):
+    print("k", k)
+    k = 100
+
+n = 0
+for i in range(5, 5):
+    n = n + 1
+for i in range(5, 0):
+    n = n + 1
+while false:
+    n = n + 1
+print("empty", n)
+
+for k in range(9223372036854775800, 9223372036854775807, 5):
+    print("near max", k)
+for k in range(-9223372036854775800, -9223372036854775807 - 1, -5):
+    print("near min", k)
+
+print(firstSquareOver(50), collatz(27), triangle(30))
+n = 0
+while n < 3:
+    for k in range(n):
+        print("nested", n, k)
+    n = n + 1
+for k in range(1, 2, 0):
+    print("not reached")
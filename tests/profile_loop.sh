@@ -0,0 +1,31 @@
+#!/bin/sh
+# A function that loops without making calls must get the samples for the
+# CPU time it uses: spin() should account for nearly all of them, not the
+# single sample taken when it returns.
+binary=$1
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+cat > "$dir/loop.py" <<'PY'
+# spin() is the leaf; warm() returns at once.
+def spin(n):
+    total = 0
+    i = 0
+    while i < n:
+        total = total + i
+        i = i + 1
+    return total
+
+def warm(n):
+    return n + 1
+
+def main():
+    x = warm(1)
+    y = spin(3000000)
+    return x + y
+
+print(main())
+PY
+"$binary" --profile "$dir/out.folded" "$dir/loop.py" || exit 1
+cat "$dir/out.folded"
+awk '{ total += $NF } /;spin:[0-9]+ [0-9]+$/ { spin += $NF }
+     END { exit !(total >= 10 && spin * 10 >= total * 8) }' "$dir/out.folded"
@@ -0,0 +1,47 @@
+#!/bin/sh
+# Runs each tests/NAME.py once per "# mypython FLAGS" line at its top and
+# compares what each run prints, stderr included, with tests/NAME.out, then
+# runs each tests/NAME.sh. A run that takes longer than 10 s fails.
+#
+# Usage: tests/run.sh [path/to/mypython]
+binary=${1:-./mypython}
+dir=$(dirname "$0")
+failed=0
+newline='
+'
+for script in "$dir"/*.py; do
+  name=${script%.py}
+  # Each mode becomes "x" followed by its flags, so a bare "# mypython"
+  # still yields a word.
+  modes=$(sed -n '/^# mypython/!q; s/^# mypython/x/p' "$script")
+  IFS=$newline
+  for mode in $modes; do
+    unset IFS
+    flags=${mode#x}
+    # -O reports how many nodes it removed on stderr; that line is left
+    # out so one expected output serves every mode.
+    if timeout 10 "$binary" $flags "$script" > "$name.actual" 2>&1 &&
+       sed -i '/^Optimizer removed [0-9]* nodes$/d' "$name.actual" &&
+       cmp -s "$name.out" "$name.actual"; then
+      rm -f "$name.actual"
+    else
+      echo "FAIL $script with flags:$flags (output kept in $name.actual)"
+      failed=1
+      break
+    fi
+  done
+  unset IFS
+done
+# Tests whose output varies from run to run check it themselves: NAME.sh
+# gets the binary as its argument and passes by exiting 0.
+for script in "$dir"/*.sh; do
+  [ "$(basename "$script")" = run.sh ] && continue
+  name=${script%.sh}
+  if timeout 10 sh "$script" "$binary" > "$name.actual" 2>&1; then
+    rm -f "$name.actual"
+  else
+    echo "FAIL $script (output kept in $name.actual)"
+    failed=1
+  fi
+done
+exit $failed
@@ -0,0 +1,27 @@
+# mypython
+# mypython --stream
+# With --stream, a freed statement's global cache entries go to the next
+# statement's reads, while a def's body keeps its own.
+scale = 3
+def scaled(n):
+    return n * scale + offset
+
+offset = 1
+print(scaled(2))
+x = scale + offset
+x = x + x - scale
+print(x)
+scale = 10
+print(scaled(2), x + scale)
+def count(n):
+    total = 0
+    for i in range(n):
+        total = total + scale
+    return total
+
+y = count(4) + scaled(1)
+print(y, scale, offset)
+offset = scale * scale
+print(scaled(y), count(1), y + offset)
+print(missing)
+print("not reached")